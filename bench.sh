@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Run from project root, after build.sh.
+#
+# Runs each module's benchmark, writing its results as JSON to
+# ${RESULTDIR}/<module>.json. If a baseline directory of results from a
+# previous run is specified, results are compared to it and the exit status is
+# non-zero if any benchmark regressed.
+#
+# Usage: bench.sh [baseline-dir [benchmark options]]
+
+BUILDDIR=build
+RESULTDIR=${RESULTDIR:-bench-results}
+BASELINEDIR=$1
+shift
+
+if [[ ! -d $RESULTDIR ]]
+then
+    mkdir $RESULTDIR
+fi
+
+status=0
+for benchmark in `ls ${BUILDDIR}/*-bench 2> /dev/null`
+do
+    module=$(basename ${benchmark} -bench)
+    options="$@"
+    if [[ -n $BASELINEDIR && -f ${BASELINEDIR}/${module}.json ]]
+    then
+        options="--baseline ${BASELINEDIR}/${module}.json ${options}"
+    fi
+    echo "running ${benchmark} ..."
+    # Write elsewhere first, as the baseline may be the results being replaced.
+    ${benchmark} ${options} > ${RESULTDIR}/${module}.json.tmp
+    rc=$?
+    mv ${RESULTDIR}/${module}.json.tmp ${RESULTDIR}/${module}.json
+    if [ "$rc" -ne "0" ]
+    then
+        status=$rc
+    fi
+done
+
+exit $status
@@ -13,13 +13,20 @@ fi
 for subdir in `ls ${SRCDIR}`
 do
     pushd ${SRCDIR}/$subdir > /dev/null
-    for srcfile in `ls *.cpp`
+    for srcfile in `ls *.cpp 2> /dev/null`
     do
         srcfile_basename=$(basename ${srcfile} .cpp)
         output_name="${subdir}-${srcfile_basename}"
+        # Benchmarks are optimized as for release.
+        if [[ $srcfile_basename == bench* ]]
+        then
+            optimize=-O2
+        else
+            optimize=-O1
+        fi
         echo -n "building ${srcfile} to ${output_name} ... "
-        clang++ \
-            -ggdb3 -Wall -Wpedantic -O1 --std=c++1y \
+        ${CXX:-clang++} \
+            -ggdb3 -Wall -Wpedantic ${optimize} --std=c++1y -pthread \
             -I../../${SRCDIR} \
             -o ../../${BUILDDIR}/${output_name} \
             ${srcfile}
@@ -12,6 +12,8 @@
 #include <map>
 #include <string>
 
+#include <common/stats.h>
+
 /// Canonicalize a word by lexicographically sorting its letters.
 ///
 /// \param word The word to canonicalize.
@@ -23,36 +25,65 @@ std::string canonicalize(const std::string& word)
     return c;
 }
 
-/// Find anagrams.
+/// Counts and phase timings of \c find_anagrams.
+template <typename Policy = common::stats::disabled>
+struct anagram_stats {
+    typename Policy::counter canonicalizations;
+    typename Policy::timer count;       /// Counting canonicalizations.
+    typename Policy::timer select;      /// Selecting the anagrams.
+};
+
+/// Find anagrams, recording statistics.
 ///
 /// \param words A list of words without duplicates.
+/// \param stats Records the canonicalizations and the time of each phase.
 /// \return all words that are anagrams of other words in the list, in their
 /// original order.
-std::list<std::string> find_anagrams(const std::list<std::string>& words)
+template <typename Policy>
+std::list<std::string> find_anagrams(
+        const std::list<std::string>& words,
+        anagram_stats<Policy>& stats)
 {
     using namespace std;
 
     // Build a table of cononicalized word occurrence counts.
     map<string, size_t> counts;
-    for (const auto& w : words) {
-        const auto c = canonicalize(w);
-        auto iter = counts.find(c);
-        if (iter == end(counts))
-            counts.insert({c, 1});
-        else
-            iter->second++;
+    {
+        const auto timing = stats.count.time();
+        for (const auto& w : words) {
+            const auto c = canonicalize(w);
+            ++stats.canonicalizations;
+            auto iter = counts.find(c);
+            if (iter == end(counts))
+                counts.insert({c, 1});
+            else
+                iter->second++;
+        }
     }
 
     // Anagrams are the words who's canonicalized form occurrs more than once.
+    const auto timing = stats.select.time();
     list<string> anagrams;
     copy_if(
             begin(words),
             end(words),
             back_inserter(anagrams),
-            [&counts] (const string& word)
+            [&counts, &stats] (const string& word)
             {
+                ++stats.canonicalizations;
                 const auto& iter = counts.find(canonicalize(word));
                 return iter != end(counts) && iter->second > 1;
             });
     return anagrams;
 }
+
+/// Find anagrams.
+///
+/// \param words A list of words without duplicates.
+/// \return all words that are anagrams of other words in the list, in their
+/// original order.
+std::list<std::string> find_anagrams(const std::list<std::string>& words)
+{
+    anagram_stats<> stats;
+    return find_anagrams(words, stats);
+}
@@ -0,0 +1,76 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Benchmark finding anagrams in word lists.
+
+#include <list>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <anagrams/anagrams.h>
+#include <anagrams/client.h>
+#include <anagrams/index.h>
+#include <anagrams/server.h>
+#include <common/bench.h>
+
+using namespace std;
+using common::bench::harness;
+using common::bench::keep;
+
+/// \return \c n distinct random words of 3 to 8 letters from a small alphabet,
+/// so many are anagrams of others.
+static list<string> generate(const size_t n)
+{
+    mt19937_64 generator(n);
+    set<string> seen;
+    list<string> words;
+    while (words.size() < n) {
+        string word(3 + generator() % 6, ' ');
+        for (auto& c : word)
+            c = 'a' + generator() % 10;
+        if (seen.insert(word).second)
+            words.push_back(word);
+    }
+    return words;
+}
+
+int main(int argc, char** argv)
+{
+    harness h(argc, argv);
+    for (size_t n : {1000, 10000, 100000}) {
+        const auto words = generate(n);
+        h.run("find_anagrams/" + to_string(n), n, [&] () {
+            keep(find_anagrams(words));
+        });
+        h.run("find_anagrams_stats/" + to_string(n), n, [&] () {
+            anagram_stats<common::stats::enabled> stats;
+            keep(find_anagrams(words, stats));
+            keep(stats.canonicalizations.value());
+        });
+    }
+
+    // Lookups on a server, one word per request and batched, pipelined.
+    const auto words = generate(100000);
+    const anagrams::anagram_index index(words);
+    const string path = "/tmp/anagrams-bench-" + to_string(getpid()) + ".sock";
+    anagrams::server server(index, path, 1);
+    anagrams::client client(path);
+    const vector<string> batch(begin(words), next(begin(words), 100));
+    h.run("server_lookup/1", 1, [&] () {
+        keep(client.lookup(vector<string>{words.front()}));
+    });
+    h.run("server_lookup/100", batch.size(), [&] () {
+        keep(client.lookup(batch));
+    });
+    h.run("server_pipelined/10x100", 10 * batch.size(), [&] () {
+        for (size_t i = 0; i < 10; ++i)
+            client.send(batch);
+        while (client.pending() > 0)
+            keep(client.receive());
+    });
+    return h.finish();
+}
@@ -0,0 +1,54 @@
+#include <anagrams/client.h>
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/// Look up the anagrams of words, from the arguments or stdin, on a server.
+int main(int argc, const char** argv)
+{
+    constexpr static const char* USAGE =
+            "Usage: %s SOCKET [WORD...]\n"
+            "    SOCKET - the path of the anagram server's socket\n"
+            "    WORD - a word to look up, else words are read from stdin\n";
+    if (argc < 2) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+
+    vector<string> words;
+    if (argc > 2) {
+        words.assign(argv + 2, argv + argc);
+    } else {
+        string word;
+        while (cin >> word)
+            words.push_back(word);
+    }
+
+    try {
+        // Pipeline the words in batches, then print each word's anagrams.
+        constexpr size_t BATCH = 1024;
+        anagrams::client client(argv[1]);
+        for (size_t i = 0; i < words.size(); i += BATCH) {
+            client.send(vector<string>(
+                        words.begin() + i,
+                        words.begin() + min(words.size(), i + BATCH)));
+        }
+        for (size_t i = 0; client.pending() > 0;) {
+            for (const auto& group : client.receive()) {
+                cout << words[i++] << ":";
+                for (const auto& anagram : group)
+                    cout << " " << anagram;
+                cout << endl;
+            }
+        }
+    } catch (const exception& e) {
+        cerr << argv[0] << ": " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
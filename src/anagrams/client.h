@@ -0,0 +1,212 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// A client of the anagram server.
+///
+/// See protocol.h for the wire protocol.
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <anagrams/protocol.h>
+
+namespace anagrams {
+
+/// A connection to an anagram server.
+///
+/// Requests may be pipelined: any number may be sent before their responses
+/// are received, in the same order. Sending is deferred until a response is
+/// received, so the requests sent meanwhile go in as few writes as possible.
+///
+/// A client is used by one thread at a time.
+class client {
+public:
+    /// The anagrams of a word.
+    using group = std::vector<std::string>;
+
+    /// Connect to the server listening at \c path.
+    ///
+    /// \exception \c std::system_error if the connection fails.
+    explicit client(const std::string& path);
+    client(const client&) = delete;
+    client& operator=(const client&) = delete;
+    ~client() { ::close(fd_); }
+
+    /// Send a request to look up the anagram groups of some words.
+    ///
+    /// \param words Any range of strings.
+    /// \exception \c std::length_error if a word or the request is too long.
+    template <typename Words>
+    void send(const Words& words);
+
+    /// Receive the response to the oldest request not yet answered.
+    ///
+    /// \return the anagram group of each word of the request, in order.
+    /// \exception \c std::logic_error if there's no request pending.
+    /// \exception \c std::runtime_error if the server closed the connection
+    ///            or the response is invalid.
+    std::vector<group> receive();
+
+    /// Send a request and receive its response.
+    template <typename Words>
+    std::vector<group> lookup(const Words& words)
+    {
+        send(words);
+        return receive();
+    }
+
+    /// \return the number of requests sent and not yet answered.
+    size_t pending() const { return pending_; }
+
+private:
+    /// Send the requests queued, receiving responses meanwhile so neither
+    /// side blocks writing to a full socket.
+    void flush();
+
+    /// Receive what's available into the input buffer.
+    void fill(int flags);
+
+    int fd_;
+    std::string out_;                   /// Requests not yet sent.
+    std::string in_;                    /// Responses received.
+    size_t head_;                       /// The next response's offset in in_.
+    size_t pending_;
+};
+
+client::client(const std::string& path) : head_(0), pending_(0)
+{
+    const sockaddr_un address = protocol::address(path);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        throw std::system_error(errno, std::generic_category(), "socket");
+    if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address)) < 0) {
+        const int error = errno;
+        ::close(fd_);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+}
+
+template <typename Words>
+void client::send(const Words& words)
+{
+    using namespace protocol;
+
+    const size_t frame = begin_frame(out_);
+    try {
+        put(out_, 4, 0);
+        uint32_t n = 0;
+        for (const auto& word : words) {
+            put(out_, word);
+            ++n;
+        }
+        for (size_t i = 0; i < 4; ++i)
+            out_[frame + HEADER + i] = static_cast<char>(n >> (8 * i));
+        if (out_.size() - frame - HEADER > MAX_PAYLOAD)
+            throw std::length_error("request too long");
+    } catch (...) {
+        out_.resize(frame);
+        throw;
+    }
+    end_frame(out_, frame);
+    ++pending_;
+}
+
+std::vector<client::group> client::receive()
+{
+    using namespace protocol;
+
+    if (pending_ == 0)
+        throw std::logic_error("no request pending");
+    flush();
+
+    auto available = [this] () { return in_.size() - head_; };
+    while (available() < HEADER ||
+            available() - HEADER < payload_length(in_.data() + head_))
+        fill(0);
+
+    const uint32_t size = payload_length(in_.data() + head_);
+    reader r(in_.data() + head_ + HEADER, size);
+    uint32_t n;
+    if (!r.get(4, n))
+        throw std::runtime_error("invalid anagram server response");
+    std::vector<group> groups(n);
+    for (auto& g : groups) {
+        uint32_t words;
+        if (!r.get(4, words))
+            throw std::runtime_error("invalid anagram server response");
+        g.resize(words);
+        for (auto& word : g)
+            if (!r.get(word))
+                throw std::runtime_error("invalid anagram server response");
+    }
+    if (!r.done())
+        throw std::runtime_error("invalid anagram server response");
+
+    // Discard the response, and any received before it once they add up.
+    head_ += HEADER + size;
+    if (head_ == in_.size()) {
+        in_.clear();
+        head_ = 0;
+    } else if (head_ >= 1 << 16) {
+        in_.erase(0, head_);
+        head_ = 0;
+    }
+    --pending_;
+    return groups;
+}
+
+void client::flush()
+{
+    size_t sent = 0;
+    while (sent < out_.size()) {
+        pollfd fd = {fd_, POLLIN | POLLOUT, 0};
+        if (::poll(&fd, 1, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "poll");
+        }
+        if (fd.revents & POLLIN)
+            fill(MSG_DONTWAIT);
+        if (!(fd.revents & (POLLOUT | POLLERR | POLLHUP)))
+            continue;
+
+        const ssize_t n = ::send(fd_, out_.data() + sent, out_.size() - sent,
+                MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if (n < 0)
+            throw std::system_error(errno, std::generic_category(), "send");
+        sent += n;
+    }
+    out_.clear();
+}
+
+void client::fill(const int flags)
+{
+    char buffer[1 << 16];
+    ssize_t n;
+    do {
+        n = ::recv(fd_, buffer, sizeof(buffer), flags);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return;
+    if (n < 0)
+        throw std::system_error(errno, std::generic_category(), "recv");
+    if (n == 0)
+        throw std::runtime_error("anagram server closed the connection");
+    in_.append(buffer, n);
+}
+
+} // namespace anagrams
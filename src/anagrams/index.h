@@ -0,0 +1,98 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// An index of a dictionary's anagram groups by canonicalization.
+///
+/// See README for the solution description.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <anagrams/anagrams.h>
+
+namespace anagrams {
+
+/// A dictionary's words grouped by canonicalization, so the anagrams of any
+/// word are found by one hash lookup.
+///
+/// The words are stored once, contiguously, sorted by canonicalization and
+/// then by word, so each group is a range of them.
+class anagram_index {
+public:
+    /// A group of anagrams: a range of the index's words.
+    class group {
+    public:
+        group() : begin_(nullptr), end_(nullptr) {}
+        group(const std::string* b, const std::string* e) : begin_(b), end_(e)
+        {}
+
+        const std::string* begin() const { return begin_; }
+        const std::string* end() const { return end_; }
+        size_t size() const { return end_ - begin_; }
+        bool empty() const { return begin_ == end_; }
+
+    private:
+        const std::string* begin_;
+        const std::string* end_;
+    };
+
+    /// \param words The dictionary, any range of strings. Duplicates are
+    ///              indexed once.
+    template <typename Words>
+    explicit anagram_index(const Words& words);
+
+    anagram_index(const anagram_index&) = delete;
+    anagram_index& operator=(const anagram_index&) = delete;
+
+    /// \return the dictionary's words that are anagrams of \c word, including
+    /// \c word itself if it's in the dictionary, in lexicographical order.
+    group find(const std::string& word) const;
+
+    /// \return the number of words indexed.
+    size_t size() const { return words_.size(); }
+
+    /// \return the number of anagram groups, including groups of one.
+    size_t groups() const { return groups_.size(); }
+
+private:
+    std::vector<std::string> words_;
+    /// The first word and the number of words of each canonicalization.
+    std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> groups_;
+};
+
+template <typename Words>
+anagram_index::anagram_index(const Words& words)
+{
+    std::vector<std::pair<std::string, std::string>> keyed;
+    for (const auto& w : words)
+        keyed.emplace_back(canonicalize(w), w);
+    std::sort(begin(keyed), end(keyed));
+    keyed.erase(std::unique(begin(keyed), end(keyed)), end(keyed));
+
+    words_.reserve(keyed.size());
+    groups_.reserve(keyed.size());
+    for (auto& k : keyed) {
+        auto& g = groups_[k.first];
+        if (g.second == 0)
+            g.first = words_.size();
+        ++g.second;
+        words_.push_back(std::move(k.second));
+    }
+}
+
+anagram_index::group anagram_index::find(const std::string& word) const
+{
+    const auto g = groups_.find(canonicalize(word));
+    if (g == end(groups_))
+        return {};
+    const std::string* const first = words_.data() + g->second.first;
+    return {first, first + g->second.second};
+}
+
+} // namespace anagrams
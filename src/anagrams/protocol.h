@@ -0,0 +1,187 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// The anagram server's wire protocol, and socket helpers shared by the server
+/// and client.
+///
+/// Requests and responses are frames: a 4 byte payload length, then the
+/// payload. A request's payload is a batch of words to look up, and its
+/// response's the anagram group of each. Integers are little endian.
+///
+///     request payload             response payload
+///     size  field                 size  field
+///     4     words                 4     groups
+///     for each word:              for each group:
+///     2     length                4     words
+///     n     bytes                 for each word:
+///                                 2     length
+///                                 n     bytes
+///
+/// A client may send any number of requests before reading the responses,
+/// which are sent in the order of the requests.
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace anagrams {
+namespace protocol {
+
+/// The largest request payload accepted.
+constexpr static const uint32_t MAX_PAYLOAD = 1 << 24;
+
+/// The largest response payload sent. A request whose response would be
+/// larger is invalid.
+constexpr static const uint32_t MAX_RESPONSE = 1 << 26;
+
+/// The longest word.
+constexpr static const size_t MAX_WORD = UINT16_MAX;
+
+/// The size of a frame's length.
+constexpr static const size_t HEADER = 4;
+
+/// Append an integer of \c size bytes.
+void put(std::string& out, const size_t size, uint64_t v)
+{
+    for (size_t i = 0; i < size; ++i, v >>= 8)
+        out.push_back(static_cast<char>(v));
+}
+
+/// Append a word, as its length and bytes.
+void put(std::string& out, const std::string& word)
+{
+    if (word.size() > MAX_WORD)
+        throw std::length_error("word too long");
+    put(out, 2, word.size());
+    out.append(word);
+}
+
+/// Start a frame at the end of \c out.
+///
+/// \return the offset of the frame, to pass to \c end_frame.
+size_t begin_frame(std::string& out)
+{
+    const size_t frame = out.size();
+    out.append(HEADER, '\0');
+    return frame;
+}
+
+/// Set the length of the frame at offset \c frame to the bytes appended since.
+void end_frame(std::string& out, const size_t frame)
+{
+    const uint64_t length = out.size() - frame - HEADER;
+    if (length > UINT32_MAX)
+        throw std::length_error("frame too long");
+    for (size_t i = 0; i < HEADER; ++i)
+        out[frame + i] = static_cast<char>(length >> (8 * i));
+}
+
+/// \pre \c in has at least \c HEADER bytes.
+/// \return the length of the payload of the frame at \c in.
+uint32_t payload_length(const char* const in)
+{
+    uint32_t length = 0;
+    for (size_t i = HEADER; i-- > 0;)
+        length = length << 8 | static_cast<uint8_t>(in[i]);
+    return length;
+}
+
+/// Reads the fields of a payload, failing, rather than reading past its end,
+/// if it's truncated.
+class reader {
+public:
+    reader(const char* in, size_t size) : in_(in), end_(in + size) {}
+
+    /// \return true iff an integer of \c size bytes was read into \c v.
+    bool get(size_t size, uint32_t& v)
+    {
+        if (size_t(end_ - in_) < size)
+            return false;
+        v = 0;
+        for (size_t i = size; i-- > 0;)
+            v = v << 8 | static_cast<uint8_t>(in_[i]);
+        in_ += size;
+        return true;
+    }
+
+    /// \return true iff a word was read into \c word.
+    bool get(std::string& word)
+    {
+        uint32_t length;
+        if (!get(2, length) || size_t(end_ - in_) < length)
+            return false;
+        word.assign(in_, length);
+        in_ += length;
+        return true;
+    }
+
+    /// \return true iff the whole payload has been read.
+    bool done() const { return in_ == end_; }
+
+private:
+    const char* in_;
+    const char* end_;
+};
+
+/// \return the address of a UNIX domain socket at \c path.
+/// \exception \c std::invalid_argument if the path is too long.
+sockaddr_un address(const std::string& path)
+{
+    sockaddr_un a;
+    std::memset(&a, 0, sizeof(a));
+    a.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(a.sun_path))
+        throw std::invalid_argument("socket path too long: " + path);
+    std::memcpy(a.sun_path, path.data(), path.size());
+    return a;
+}
+
+/// Send all \c size bytes at \c data.
+///
+/// \return false iff the peer closed the connection.
+/// \exception \c std::system_error on other errors.
+bool send_all(const int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EPIPE || errno == ECONNRESET))
+            return false;
+        if (n < 0)
+            throw std::system_error(errno, std::generic_category(), "send");
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+/// Receive what's available, up to \c size bytes, waiting for at least one.
+///
+/// \return the number of bytes received, 0 iff the peer closed the
+///         connection.
+/// \exception \c std::system_error on errors.
+size_t receive_some(const int fd, char* const data, const size_t size)
+{
+    while (true) {
+        const ssize_t n = ::recv(fd, data, size, 0);
+        if (n >= 0)
+            return n;
+        if (errno == ECONNRESET)
+            return 0;
+        if (errno != EINTR)
+            throw std::system_error(errno, std::generic_category(), "recv");
+    }
+}
+
+} // namespace protocol
+} // namespace anagrams
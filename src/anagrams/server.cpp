@@ -0,0 +1,63 @@
+#include <anagrams/index.h>
+#include <anagrams/server.h>
+
+#include <csignal>
+#include <exception>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+using namespace std;
+
+/// Serve the anagrams of a dictionary read from stdin until interrupted.
+int main(int argc, const char** argv)
+{
+    constexpr static const char* USAGE =
+            "Usage: %s SOCKET [THREADS] < DICTIONARY\n"
+            "    SOCKET - the path of the UNIX domain socket to listen on\n"
+            "    THREADS - the number of connections served at once\n"
+            "              (default: the hardware concurrency)\n"
+            "    DICTIONARY - whitespace separated words\n";
+
+    const int threads = argc > 2 ? atoi(argv[2]) : 0;
+    if (argc < 2 || argc > 3 || threads < 0) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 1;
+    }
+
+    try {
+        vector<string> words;
+        string word;
+        while (cin >> word)
+            words.push_back(word);
+        const anagrams::anagram_index index(words);
+        cerr << "indexed " << index.size() << " words in " << index.groups()
+            << " anagram groups" << endl;
+
+        // Block the signals to stop on in every thread, so the main thread waits
+        // for them while the server's workers run.
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        sigaddset(&signals, SIGHUP);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        anagrams::server server(index, argv[1], threads);
+        cerr << "listening on " << argv[1] << endl;
+        int signal;
+        sigwait(&signals, &signal);
+
+        server.stop();
+        cerr << "answered " << server.requests() << " requests of "
+            << server.queries() << " words" << endl;
+    } catch (const exception& e) {
+        cerr << argv[0] << ": " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
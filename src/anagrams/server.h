@@ -0,0 +1,345 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// A server answering anagram lookups from an index over a UNIX domain socket.
+///
+/// See protocol.h for the wire protocol.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <anagrams/index.h>
+#include <anagrams/protocol.h>
+
+namespace anagrams {
+
+/// Serves the anagram groups of an index over a UNIX domain socket.
+///
+/// Each of a fixed number of worker threads accepts connections and serves
+/// all those it accepted, waiting on them at once with poll, so that idle
+/// clients don't hold up the others. All the complete requests a worker
+/// receives on a connection at once are answered before the responses are
+/// sent in one write, so pipelined requests are answered in batches. Answering
+/// is paused while a connection's unsent responses exceed \c BUFFERED bytes,
+/// so a client that doesn't read them can't make the server buffer without
+/// bound. The index is read-only, so workers share it without locking.
+class server {
+public:
+    /// The bytes of unsent responses beyond which a connection's requests
+    /// aren't answered until some are sent.
+    constexpr static const size_t BUFFERED = 1 << 20;
+
+    /// Listen on a socket at \c path, replacing any stale socket there, and
+    /// start the workers.
+    ///
+    /// \param index The index to serve, which must outlive the server.
+    /// \param path The socket's path.
+    /// \param threads The number of workers, or 0 for the hardware
+    ///                concurrency.
+    /// \exception \c std::system_error if the socket can't be created, e.g.
+    ///            if another server is listening at \c path, or there's a
+    ///            file other than a socket there.
+    server(const anagram_index& index, const std::string& path,
+            size_t threads = 0);
+    server(const server&) = delete;
+    server& operator=(const server&) = delete;
+
+    /// Stop, and remove the socket file.
+    ~server();
+
+    /// Stop accepting connections, close those open and wait for the workers
+    /// to finish.
+    void stop();
+
+    /// \return the number of requests answered.
+    uint64_t requests() const { return requests_; }
+
+    /// \return the number of words looked up.
+    uint64_t queries() const { return queries_; }
+
+private:
+    /// A non-blocking connection and its buffers.
+    struct connection {
+        int fd;
+        std::string in;                 /// Requests received, not answered.
+        std::string out;                /// Responses, sent up to \c sent.
+        size_t sent;
+
+        /// \return the events to poll for: input until a request is complete,
+        ///         and output while responses are unsent.
+        short events() const;
+    };
+
+    /// Accept and serve connections until stopped.
+    void run();
+
+    /// Receive, answer and send what a connection is ready for, without
+    /// blocking.
+    ///
+    /// \param buffer Scratch space to receive into.
+    /// \return false iff the connection is closed, failed or sent an invalid
+    ///         request, and so must be closed.
+    bool serve(connection& c, char* buffer, size_t size);
+
+    /// Append the response to a request's payload to \c out.
+    ///
+    /// \return false iff the request is invalid, e.g. its response would be
+    ///         longer than \c protocol::MAX_RESPONSE, which is checked as
+    ///         it's built.
+    bool answer(const char* payload, uint32_t size, std::string& out);
+
+    const anagram_index& index_;
+    const std::string path_;
+    int listener_;
+    int wake_[2];                       /// A pipe written to stop the workers.
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stopping_;
+
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> queries_;
+};
+
+server::server(
+        const anagram_index& index,
+        const std::string& path,
+        size_t threads) :
+    index_(index),
+    path_(path),
+    stopping_(false),
+    requests_(0),
+    queries_(0)
+{
+    const sockaddr_un address = protocol::address(path);
+    listener_ = ::socket(
+            AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener_ < 0)
+        throw std::system_error(errno, std::generic_category(), "socket");
+
+    // Replace a stale socket, which nothing's listening on so it refuses
+    // connections, but nothing else.
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            ::close(listener_);
+            throw std::system_error(EEXIST, std::generic_category(), path);
+        }
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe < 0) {
+            const int error = errno;
+            ::close(listener_);
+            throw std::system_error(error, std::generic_category(), "socket");
+        }
+        const int connected = ::connect(probe,
+                reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        const int error = errno;
+        ::close(probe);
+        if (connected == 0 || error != ECONNREFUSED) {
+            ::close(listener_);
+            throw std::system_error(EADDRINUSE, std::generic_category(), path);
+        }
+        ::unlink(path.c_str());
+    }
+
+    if (::bind(listener_, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address)) < 0 ||
+            ::listen(listener_, SOMAXCONN) < 0 ||
+            ::pipe2(wake_, O_CLOEXEC) < 0) {
+        const int error = errno;
+        ::close(listener_);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+
+    if (threads == 0)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threads; ++i)
+        workers_.emplace_back([this] () { run(); });
+}
+
+server::~server()
+{
+    stop();
+    ::close(listener_);
+    ::close(wake_[0]);
+    ::close(wake_[1]);
+    ::unlink(path_.c_str());
+}
+
+void server::stop()
+{
+    if (stopping_.exchange(true))
+        return;
+
+    // The pipe stays readable, waking all the workers, which close their
+    // connections.
+    const char byte = 0;
+    while (::write(wake_[1], &byte, 1) < 0 && errno == EINTR)
+        ;
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+short server::connection::events() const
+{
+    using protocol::HEADER;
+
+    short events = 0;
+    if (in.size() < HEADER ||
+            in.size() - HEADER < protocol::payload_length(in.data()))
+        events |= POLLIN;
+    if (sent < out.size())
+        events |= POLLOUT;
+    return events;
+}
+
+void server::run()
+{
+    std::vector<connection> connections;
+    std::vector<pollfd> fds;
+    char buffer[1 << 16];
+    while (true) {
+        fds.clear();
+        fds.push_back({wake_[0], POLLIN, 0});
+        fds.push_back({listener_, POLLIN, 0});
+        for (const auto& c : connections)
+            fds.push_back({c.fd, c.events(), 0});
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;                                  // Can't wait: give up.
+        }
+        if (fds[0].revents)
+            break;                                  // Stopping.
+
+        // Backwards, so that a connection closed is replaced by one served.
+        for (size_t i = connections.size(); i-- > 0;) {
+            if (!fds[i + 2].revents)
+                continue;
+            bool open;
+            try {
+                open = serve(connections[i], buffer, sizeof(buffer));
+            } catch (const std::exception&) {
+                open = false;
+            }
+            if (open)
+                continue;
+            ::close(connections[i].fd);
+            if (i + 1 < connections.size())
+                connections[i] = std::move(connections.back());
+            connections.pop_back();
+        }
+
+        if (fds[1].revents) {
+            // Another worker may have taken the connection.
+            const int fd = ::accept4(listener_, nullptr, nullptr,
+                    SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0)
+                connections.push_back({fd, {}, {}, 0});
+        }
+    }
+
+    for (const auto& c : connections)
+        ::close(c.fd);
+}
+
+bool server::serve(connection& c, char* const buffer, const size_t size)
+{
+    using namespace protocol;
+
+    // Poll may have woken only for output, so nothing may be received.
+    if (c.events() & POLLIN) {
+        const ssize_t n = ::recv(c.fd, buffer, size, 0);
+        if (n == 0)
+            return false;
+        if (n > 0)
+            c.in.append(buffer, n);
+        else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return false;
+    }
+
+    while (true) {
+        // Answer every complete request received, then send the responses.
+        size_t offset = 0;
+        while (c.out.size() - c.sent < BUFFERED &&
+                c.in.size() - offset >= HEADER) {
+            const uint32_t length = payload_length(c.in.data() + offset);
+            if (length > MAX_PAYLOAD)
+                return false;
+            if (c.in.size() - offset - HEADER < length)
+                break;
+            if (!answer(c.in.data() + offset + HEADER, length, c.out))
+                return false;
+            offset += HEADER + length;
+        }
+        c.in.erase(0, offset);
+
+        if (c.sent == c.out.size())
+            return true;
+        const ssize_t n = ::send(c.fd, c.out.data() + c.sent,
+                c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                    errno == EINTR))
+            return true;
+        if (n < 0 && (errno == EPIPE || errno == ECONNRESET))
+            return false;
+        if (n < 0)
+            throw std::system_error(errno, std::generic_category(), "send");
+        c.sent += n;
+        if (c.sent < c.out.size())
+            return true;                            // Wait for room.
+
+        // All sent: answer any requests held back meanwhile.
+        c.out.clear();
+        c.sent = 0;
+    }
+}
+
+bool server::answer(const char* const payload, const uint32_t size,
+        std::string& out)
+{
+    using namespace protocol;
+
+    reader r(payload, size);
+    uint32_t words;
+    if (!r.get(4, words))
+        return false;
+
+    const size_t frame = begin_frame(out);
+    put(out, 4, words);
+    std::string word;
+    for (uint32_t i = 0; i < words; ++i) {
+        if (!r.get(word))
+            return false;
+        const auto group = index_.find(word);
+        put(out, 4, group.size());
+        for (const auto& anagram : group)
+            put(out, anagram);
+        if (out.size() - frame - HEADER > MAX_RESPONSE)
+            return false;
+    }
+    if (!r.done())
+        return false;
+    end_frame(out, frame);
+
+    ++requests_;
+    queries_ += words;
+    return true;
+}
+
+} // namespace anagrams
@@ -0,0 +1,230 @@
+#include <cassert>
+#include <cerrno>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <anagrams/anagrams.h>
+#include <anagrams/client.h>
+#include <anagrams/index.h>
+#include <anagrams/server.h>
+
+using namespace std;
+using namespace anagrams;
+
+/// \return \c n distinct random words from a small alphabet, so many are
+/// anagrams of others.
+static list<string> generate(const size_t n)
+{
+    mt19937_64 generator(n);
+    set<string> seen;
+    list<string> words;
+    while (words.size() < n) {
+        string word(2 + generator() % 4, ' ');
+        for (auto& c : word)
+            c = 'a' + generator() % 6;
+        if (seen.insert(word).second)
+            words.push_back(word);
+    }
+    return words;
+}
+
+/// Check the index's groups agree with find_anagrams.
+static void test_index()
+{
+    const auto words = generate(500);
+    const anagram_index index(words);
+    assert(index.size() == words.size());
+
+    const auto anagrams = find_anagrams(words);
+    const set<string> expected(begin(anagrams), end(anagrams));
+    size_t grouped = 0;
+    for (const auto& w : words) {
+        const auto g = index.find(w);
+        assert((g.size() > 1) == (expected.count(w) == 1));
+        assert(find(g.begin(), g.end(), w) != g.end());
+        for (const auto& a : g)
+            assert(canonicalize(a) == canonicalize(w));
+        grouped += g.size() > 1;
+    }
+    assert(grouped == anagrams.size());
+
+    assert(index.find("zzz").empty());
+    const anagram_index duplicates(vector<string>{"ab", "ba", "ab"});
+    assert(duplicates.size() == 2 && duplicates.groups() == 1);
+    assert(duplicates.find("ab").size() == 2);
+}
+
+/// \return the expected response to a lookup of \c words.
+static vector<client::group> expect(
+        const anagram_index& index,
+        const vector<string>& words)
+{
+    vector<client::group> groups;
+    for (const auto& w : words) {
+        const auto g = index.find(w);
+        groups.emplace_back(g.begin(), g.end());
+    }
+    return groups;
+}
+
+/// Check lookups, pipelined and concurrent, and invalid requests.
+static void test_server()
+{
+    const auto words = generate(2000);
+    const anagram_index index(words);
+    const string path = "/tmp/anagrams-test-" + to_string(getpid()) + ".sock";
+    server s(index, path, 3);
+
+    // A server listening on the path isn't replaced, but a stale socket is.
+    bool thrown = false;
+    try {
+        server second(index, path, 1);
+    } catch (const system_error& e) {
+        thrown = e.code().value() == EADDRINUSE;
+    }
+    assert(thrown);
+    {
+        const string stale = path + ".stale";
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const sockaddr_un address = protocol::address(stale);
+        ::bind(fd, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address));
+        ::close(fd);
+        server replacing(index, stale, 1);
+        assert(client(stale).lookup(vector<string>{"abc"}) ==
+                expect(index, {"abc"}));
+    }
+
+    // Nor is a file other than a socket.
+    {
+        const string regular = path + ".txt";
+        ofstream(regular) << "precious" << endl;
+        thrown = false;
+        try {
+            server refused(index, regular, 1);
+        } catch (const system_error& e) {
+            thrown = e.code().value() == EEXIST;
+        }
+        assert(thrown);
+        string contents;
+        ifstream(regular) >> contents;
+        assert(contents == "precious");
+        ::unlink(regular.c_str());
+    }
+
+    // Single, empty and pipelined requests.
+    client c(path);
+    const vector<string> some = {"abc", "cab", "zzz", "", words.front()};
+    assert(c.lookup(some) == expect(index, some));
+    assert(c.lookup(vector<string>()).empty());
+    vector<vector<string>> batches;
+    for (size_t i = 0; i < 300; ++i) {
+        vector<string> batch;
+        for (size_t j = 0; j <= i % 50; ++j)
+            batch.push_back(*next(begin(words), (i * 31 + j * 7) % words.size()));
+        c.send(batch);
+        batches.push_back(batch);
+    }
+    assert(c.pending() == batches.size());
+    for (const auto& batch : batches)
+        assert(c.receive() == expect(index, batch));
+    thrown = false;
+    try {
+        c.receive();
+    } catch (const logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Concurrent clients, more than workers.
+    vector<thread> threads;
+    for (size_t t = 0; t < 5; ++t) {
+        threads.emplace_back([&, t] () {
+            client tc(path);
+            for (size_t i = 0; i < 200; ++i) {
+                const vector<string> batch = {
+                    *next(begin(words), (t * 200 + i) % words.size()) };
+                assert(tc.lookup(batch) == expect(index, batch));
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    // Idle connections, more than workers, don't hold up the others.
+    {
+        list<client> idle;
+        for (size_t i = 0; i < 8; ++i) {
+            idle.emplace_back(path);
+            assert(idle.back().lookup(some) == expect(index, some));
+        }
+        assert(client(path).lookup(some) == expect(index, some));
+        assert(c.lookup(some) == expect(index, some));
+    }
+
+    // A truncated request closes the connection, but not the server.
+    {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const sockaddr_un address = protocol::address(path);
+        ::connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address));
+        const char request[] = {6, 0, 0, 0, 1, 0, 0, 0, 9, 0};
+        ::send(fd, request, sizeof(request), 0);
+        char byte;
+        assert(::recv(fd, &byte, 1, 0) == 0);
+        ::close(fd);
+    }
+
+    // So does a request whose response would be too long.
+    {
+        string word = words.front();
+        for (const auto& w : words)
+            if (index.find(w).size() > index.find(word).size())
+                word = w;
+        size_t response = 4;
+        for (const auto& anagram : index.find(word))
+            response += 2 + anagram.size();
+        const vector<string> flood(
+                protocol::MAX_RESPONSE / response + 1, word);
+        client fc(path);
+        thrown = false;
+        try {
+            fc.lookup(flood);
+        } catch (const runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    assert(c.lookup(some) == expect(index, some));
+    assert(s.queries() > 0 && s.requests() >= batches.size() + 1000);
+
+    // Stopping closes open connections.
+    s.stop();
+    c.send(some);
+    thrown = false;
+    try {
+        c.receive();
+    } catch (const exception&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main(int argc, char** argv)
+{
+    test_index();
+    test_server();
+    cout << "ok" << endl;
+    return 0;
+}
@@ -0,0 +1,304 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// A benchmark harness reporting JSON and comparing against a baseline.
+///
+/// A benchmark program includes this header in its only translation unit, as
+/// it replaces the global \c operator \c new and \c operator \c delete to
+/// count allocations.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace common {
+namespace bench {
+
+/// Allocations counted by the replaced \c operator \c new.
+struct allocations {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> bytes;
+};
+
+allocations& allocated()
+{
+    static allocations a;
+    return a;
+}
+
+/// The measurements of a benchmark.
+struct result {
+    std::string name;
+    size_t n;                       /// The input size.
+    size_t iterations;
+    double seconds;                 /// Mean time per iteration.
+    double throughput;              /// Input items per second.
+    double allocations;             /// Mean allocations per iteration.
+    double allocated_bytes;         /// Mean bytes allocated per iteration.
+    long peak_rss_kb;               /// Peak RSS while running, or -1.
+};
+
+/// Reset the process's peak resident set size to its current size, as
+/// supported by Linux since 4.0.
+///
+/// \return true iff reset.
+bool reset_peak_rss()
+{
+    std::ofstream os("/proc/self/clear_refs");
+    return static_cast<bool>(os << "5" << std::flush);
+}
+
+/// \return the process's peak resident set size in KB since it was last
+///         reset, or -1 if unknown.
+long peak_rss_kb()
+{
+    std::ifstream is("/proc/self/status");
+    std::string line;
+    while (std::getline(is, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::atol(line.c_str() + 6);
+    return -1;
+}
+
+/// Runs benchmarks and reports their results as JSON, one result object per
+/// line, on \c stdout.
+///
+/// Options:
+///     --filter S      Only run benchmarks whose names contain S.
+///     --min-time T    Repeat each benchmark for at least T seconds (0.2).
+///     --baseline F    Compare times and allocations to the results in file F,
+///                     as output by a previous run, and fail if any is slower,
+///                     or allocates more, by more than the threshold.
+///     --threshold X   The fraction more that's a regression (0.1).
+///
+/// The peak RSS of each benchmark is that of the process while it runs,
+/// including its inputs, found by resetting the process's peak beforehand,
+/// or -1 if the kernel can't reset it.
+class harness {
+public:
+    /// Parse the options, exiting with a usage message if they're invalid.
+    harness(int argc, const char* const* argv);
+
+    /// Run a benchmark, i.e. call \c f repeatedly, unless filtered out.
+    ///
+    /// \param name The benchmark's name, unique within the program.
+    /// \param n The input size, by which throughput is measured.
+    /// \param f The function to benchmark.
+    template <typename F>
+    void run(const std::string& name, size_t n, F f);
+
+    /// Output the results, and compare them to the baseline, if any.
+    ///
+    /// \return the program's exit status: non-zero iff there's a regression,
+    ///         or none of the results are in the baseline.
+    int finish();
+
+private:
+    /// Read results output by a previous run.
+    ///
+    /// \exception \c std::runtime_error if the file can't be read or has no
+    ///            results, e.g. it was truncated.
+    static std::map<std::string, result> read(const std::string& filename);
+
+    /// \return the string value of the field \c key of a result line.
+    static std::string field(const std::string& line, const std::string& key);
+
+    std::string filter_;
+    double min_time_;
+    std::string baseline_;
+    double threshold_;
+    std::vector<result> results_;
+};
+
+harness::harness(const int argc, const char* const* const argv) :
+    min_time_(0.2),
+    threshold_(0.1)
+{
+    constexpr static const char* USAGE =
+            "Usage: %s [--filter S] [--min-time T] [--baseline F] "
+            "[--threshold X]\n";
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        const char* const value = i + 1 < argc ? argv[++i] : nullptr;
+        if (value && option == "--filter") {
+            filter_ = value;
+        } else if (value && option == "--min-time") {
+            min_time_ = std::atof(value);
+        } else if (value && option == "--baseline") {
+            baseline_ = value;
+        } else if (value && option == "--threshold") {
+            threshold_ = std::atof(value);
+        } else {
+            fprintf(stderr, USAGE, argv[0]);
+            std::exit(2);
+        }
+    }
+}
+
+template <typename F>
+void harness::run(const std::string& name, const size_t n, F f)
+{
+    using clock = std::chrono::steady_clock;
+
+    if (name.find(filter_) == std::string::npos)
+        return;
+
+    const bool reset = reset_peak_rss();
+    f();                                    // Warm up.
+
+    const uint64_t count = allocated().count;
+    const uint64_t bytes = allocated().bytes;
+    const auto start = clock::now();
+    size_t iterations = 0;
+    double seconds = 0;
+    do {
+        f();
+        ++iterations;
+        seconds = std::chrono::duration<double>(clock::now() - start).count();
+    } while (seconds < min_time_);
+
+    result r;
+    r.name = name;
+    r.n = n;
+    r.iterations = iterations;
+    r.seconds = seconds / iterations;
+    r.throughput = n / r.seconds;
+    r.allocations = double(allocated().count - count) / iterations;
+    r.allocated_bytes = double(allocated().bytes - bytes) / iterations;
+    r.peak_rss_kb = reset ? peak_rss_kb() : -1;
+    results_.push_back(r);
+    std::cerr << name << ": " << r.seconds << " s" << std::endl;
+}
+
+int harness::finish()
+{
+    for (const auto& r : results_) {
+        printf("{\"name\": \"%s\", \"n\": %zu, \"iterations\": %zu, "
+                "\"seconds\": %.9g, \"throughput\": %.9g, "
+                "\"allocations\": %.9g, \"allocated_bytes\": %.9g, "
+                "\"peak_rss_kb\": %ld}\n",
+                r.name.c_str(), r.n, r.iterations,
+                r.seconds, r.throughput,
+                r.allocations, r.allocated_bytes,
+                r.peak_rss_kb);
+    }
+    if (baseline_.empty())
+        return 0;
+
+    const auto baseline = read(baseline_);
+    int status = 0;
+    size_t compared = 0;
+    for (const auto& r : results_) {
+        const auto b = baseline.find(r.name);
+        if (b == end(baseline))
+            continue;
+        ++compared;
+        const double change = r.seconds / b->second.seconds - 1;
+        if (change > threshold_) {
+            fprintf(stderr, "REGRESSION %s: %.3g s vs %.3g s (%+.1f%%)\n",
+                    r.name.c_str(), r.seconds, b->second.seconds,
+                    100 * change);
+            status = 1;
+        }
+
+        // Allow half an allocation more, so a benchmark that didn't allocate
+        // may allocate a little in its first iterations, but not per
+        // iteration.
+        const double allocations = b->second.allocations;
+        if (allocations >= 0 &&
+                r.allocations > allocations * (1 + threshold_) + 0.5) {
+            fprintf(stderr, "REGRESSION %s: %.3g allocations vs %.3g\n",
+                    r.name.c_str(), r.allocations, allocations);
+            status = 1;
+        }
+    }
+
+    // Comparing nothing would pass, e.g. against another program's results.
+    if (compared == 0 && !results_.empty()) {
+        fprintf(stderr, "none of the results are in baseline %s\n",
+                baseline_.c_str());
+        status = 1;
+    }
+    return status;
+}
+
+std::map<std::string, result> harness::read(const std::string& filename)
+{
+    std::ifstream is(filename);
+    if (!is)
+        throw std::runtime_error("can't read baseline " + filename);
+
+    std::map<std::string, result> results;
+    std::string line;
+    while (std::getline(is, line)) {
+        const auto name = field(line, "name");
+        if (name.empty())
+            continue;
+        result& r = results[name];
+        r.name = name;
+        r.seconds = std::stod(field(line, "seconds"));
+        const auto allocations = field(line, "allocations");
+        r.allocations = allocations.empty() ? -1 : std::stod(allocations);
+    }
+    if (results.empty())
+        throw std::runtime_error("no results in baseline " + filename);
+    return results;
+}
+
+std::string harness::field(const std::string& line, const std::string& key)
+{
+    const std::string quoted = "\"" + key + "\": ";
+    auto i = line.find(quoted);
+    if (i == std::string::npos)
+        return {};
+    i += quoted.size();
+    if (line[i] == '"') {
+        const auto j = line.find('"', i + 1);
+        return line.substr(i + 1, j - i - 1);
+    }
+    return line.substr(i, line.find_first_of(",}", i) - i);
+}
+
+/// Prevent the compiler optimizing away the computation of a value.
+template <typename T>
+void keep(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+} // namespace bench
+} // namespace common
+
+// Not inlined, so the compiler can't see the replaced operators' allocation
+// functions mismatch.
+__attribute__((noinline)) void* operator new(const size_t size)
+{
+    auto& a = common::bench::allocated();
+    ++a.count;
+    a.bytes += size;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* const p) noexcept
+{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* const p, size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,104 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Instrumentation policies for counting and timing the work of an algorithm.
+///
+/// An instrumented algorithm takes a statistics struct, templated on a policy,
+/// whose members are the policy's counters and timers, e.g.
+///
+///     template <typename Policy = common::stats::disabled>
+///     struct search_stats {
+///         typename Policy::counter expanded;
+///         typename Policy::timer search;
+///     };
+///
+/// The algorithm increments the counters and times its phases, each within a
+/// scope, as
+///
+///     const auto timing = stats.search.time();
+///     ...
+///     ++stats.expanded;
+///
+/// and the caller reads them after the call. The disabled policy's members are
+/// empty and their operations are empty inline functions, so they compile to
+/// nothing. The enabled policy's counters are plain integers, as a statistics
+/// struct belongs to one call, and its timers read the steady clock twice per
+/// phase.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace common {
+namespace stats {
+
+/// Records nothing.
+struct disabled {
+    struct counter {
+        void operator++() {}
+        void operator+=(uint64_t) {}
+        uint64_t value() const { return 0; }
+    };
+
+    struct timer {
+        struct scope {
+            ~scope() {}                 // Not an unused trivial variable.
+        };
+
+        scope time() { return {}; }
+        double seconds() const { return 0; }
+    };
+};
+
+/// Records counts and the total time of phases.
+struct enabled {
+    class counter {
+    public:
+        void operator++() { ++n_; }
+        void operator+=(uint64_t n) { n_ += n; }
+        uint64_t value() const { return n_; }
+
+    private:
+        uint64_t n_ = 0;
+    };
+
+    class timer {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /// Adds the time from its construction to its destruction to a timer.
+        class scope {
+        public:
+            explicit scope(timer& t) : t_(&t), start_(clock::now()) {}
+            scope(scope&& o) : t_(o.t_), start_(o.start_) { o.t_ = nullptr; }
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            ~scope()
+            {
+                if (t_)
+                    t_->elapsed_ += clock::now() - start_;
+            }
+
+        private:
+            timer* t_;                  /// Null if moved from.
+            clock::time_point start_;
+        };
+
+        /// \return a scope timing a phase until it's destroyed.
+        scope time() { return scope(*this); }
+
+        /// \return the total time of the phases timed.
+        double seconds() const
+        {
+            return std::chrono::duration<double>(elapsed_).count();
+        }
+
+    private:
+        clock::duration elapsed_ = clock::duration::zero();
+    };
+};
+
+} // namespace stats
+} // namespace common
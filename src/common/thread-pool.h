@@ -0,0 +1,177 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// A work-stealing thread pool.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace common {
+
+/// A fixed size pool of worker threads, each with its own task queue.
+///
+/// A worker takes tasks from the back of its own queue, most recent first, and
+/// when that's empty steals from the front of the other workers' queues, oldest
+/// first. Tasks submitted from a worker go to that worker's queue, others are
+/// dealt to the queues in turn.
+///
+/// Tasks are passed the index, in [0, size()), of the worker running them, so
+/// they may use per-worker scratch space without synchronization.
+class thread_pool {
+public:
+    using task = std::function<void (size_t worker)>;
+
+    /// \param threads The number of workers, or 0 for the hardware
+    ///                concurrency.
+    explicit thread_pool(size_t threads = 0);
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /// Finish all submitted tasks and stop the workers.
+    ~thread_pool();
+
+    /// \return the number of workers.
+    size_t size() const { return workers_.size(); }
+
+    /// Submit a task to be run by a worker.
+    void submit(task t);
+
+    /// Wait until all submitted tasks, including those they submit, have
+    /// finished.
+    ///
+    /// \pre Not called from a task.
+    void wait();
+
+private:
+    struct queue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    bool pop(size_t worker, task& t);
+    void run(size_t worker);
+
+    std::vector<std::unique_ptr<queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;                  /// Guards sleeping and waking.
+    std::condition_variable wake_;      /// Tasks were queued or stopping.
+    std::condition_variable idle_;      /// No tasks are unfinished.
+    std::atomic<size_t> queued_;        /// Tasks queued and not yet taken.
+    size_t unfinished_;                 /// Tasks submitted and not finished.
+    size_t next_;                       /// The queue to deal to next.
+    bool stop_;
+
+    /// The pool and index of the worker running on this thread, if any.
+    static thread_local thread_pool* pool_;
+    static thread_local size_t worker_;
+};
+
+thread_local thread_pool* thread_pool::pool_ = nullptr;
+thread_local size_t thread_pool::worker_ = 0;
+
+thread_pool::thread_pool(size_t threads) :
+    queued_(0),
+    unfinished_(0),
+    next_(0),
+    stop_(false)
+{
+    if (threads == 0)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threads; ++i)
+        queues_.emplace_back(new queue);
+    for (size_t i = 0; i < threads; ++i)
+        workers_.emplace_back([this, i] () { run(i); });
+}
+
+thread_pool::~thread_pool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+void thread_pool::submit(task t)
+{
+    // Count the task before queueing it so it's never taken before counted.
+    size_t i;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++unfinished_;
+        ++queued_;
+        i = pool_ == this ? worker_ : next_++ % queues_.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+        queues_[i]->tasks.push_back(std::move(t));
+    }
+    wake_.notify_one();
+}
+
+void thread_pool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] () { return unfinished_ == 0; });
+}
+
+/// Take a task from the worker's own queue, else steal one from another's.
+bool thread_pool::pop(const size_t worker, task& t)
+{
+    for (size_t k = 0; k < queues_.size(); ++k) {
+        queue& q = *queues_[(worker + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty())
+            continue;
+        if (k == 0) {
+            t = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            t = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        --queued_;
+        return true;
+    }
+    return false;
+}
+
+void thread_pool::run(const size_t worker)
+{
+    pool_ = this;
+    worker_ = worker;
+
+    task t;
+    while (true) {
+        if (pop(worker, t)) {
+            t(worker);
+            t = nullptr;
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--unfinished_ == 0)
+                idle_.notify_all();
+            continue;
+        }
+
+        // Sleep until tasks are queued or the pool stops.
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this] () { return stop_ || queued_ > 0; });
+        if (stop_ && queued_ == 0)
+            return;
+    }
+}
+
+} // namespace common
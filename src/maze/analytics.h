@@ -0,0 +1,155 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Maze statistics: longest path, dead ends and branching.
+///
+/// See README for problem and solution description.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// Statistics of a perfect maze.
+struct statistics {
+    size_t rooms = 0;
+    size_t dead_ends = 0;               /// Rooms with a single door.
+    std::array<size_t, 5> doors = {};   /// The number of rooms by door count.
+    size_t diameter = 0;                /// Doors on the longest path.
+    coord from = {0, 0};                /// The ends of a longest path.
+    coord to = {0, 0};
+};
+
+/// Directions packed 2 bits per room.
+class packed_directions {
+public:
+    explicit packed_directions(const size_t n) : bits_((n + 3) / 4, 0) {}
+
+    direction get(const size_t i) const
+    {
+        return static_cast<direction>(1 << ((bits_[i / 4] >> shift(i)) & 3));
+    }
+
+    void set(const size_t i, const direction d)
+    {
+        const uint8_t k = d == up ? 0 : d == right ? 1 : d == down ? 2 : 3;
+        bits_[i / 4] = (bits_[i / 4] & ~(3 << shift(i))) | (k << shift(i));
+    }
+
+private:
+    static size_t shift(const size_t i) { return 2 * (i % 4); }
+
+    std::vector<uint8_t> bits_;
+};
+
+/// Find the room farthest from room \c start by breadth first search.
+///
+/// The maze is a tree, so rooms needn't be marked visited: a room's only
+/// visited neighbour is the one it was reached from, which is carried in the
+/// frontier. Only the frontier is stored, unless \c parents is specified, in
+/// which case each room's direction back towards \c start is recorded.
+///
+/// \exception \c std::logic_error if the maze has a cycle.
+/// \return the farthest room and its distance from \c start.
+template <typename Maze>
+std::pair<coord, size_t> farthest(
+        const Maze& m,
+        const coord& start,
+        packed_directions* const parents = nullptr)
+{
+    const size_t C = cols(m);
+    const size_t rooms = rows(m) * C;
+
+    // Frontier entries pack a room index above the direction back to the room
+    // it was entered from, or 0 for the start.
+    std::vector<uint64_t> frontier = {(start.row * C + start.col) << 4};
+    std::vector<uint64_t> next;
+    size_t distance = 0;
+    size_t visited = 1;
+    size_t last = frontier.front() >> 4;
+    while (true) {
+        for (const auto e : frontier) {
+            const size_t i = e >> 4;
+            const auto& room = m[i / C][i % C];
+            for (auto direction : {up, right, down, left}) {
+                if (!room.has_door(direction) || direction == (e & 0xf))
+                    continue;
+                const auto d = delta(direction);
+                const size_t n = (i / C + d.first) * C + (i % C + d.second);
+                const auto back = reverse(direction);
+                if (parents)
+                    parents->set(n, back);
+                next.push_back((n << 4) | back);
+            }
+        }
+        if (next.empty())
+            break;
+
+        visited += next.size();
+        if (visited > rooms)
+            throw std::logic_error("maze is not a tree");
+        ++distance;
+        last = next.back() >> 4;
+        frontier.swap(next);
+        next.clear();
+    }
+    return {{last / C, last % C}, distance};
+}
+
+/// Compute a perfect maze's statistics.
+///
+/// A linear scan of the rooms' doors counts dead ends and branching. The
+/// diameter, the longest path, is found by two breadth first searches: the
+/// room farthest from any room is one end of a longest path, and the room
+/// farthest from it is the other.
+///
+/// \pre \c m is a perfect maze.
+/// \exception \c std::logic_error if the maze has a cycle.
+template <typename Maze>
+statistics analyze(const Maze& m)
+{
+    statistics s;
+    s.rooms = rows(m) * cols(m);
+    for (size_t r = 0; r < rows(m); ++r)
+        for (size_t c = 0; c < cols(m); ++c)
+            ++s.doors[__builtin_popcount(m[r][c].doors())];
+    s.dead_ends = s.doors[1];
+
+    s.from = farthest(m, {0, 0}).first;
+    const auto end = farthest(m, s.from);
+    s.to = end.first;
+    s.diameter = end.second;
+    return s;
+}
+
+/// \pre \c m is a perfect maze.
+/// \exception \c std::logic_error if the maze has a cycle.
+/// \return a longest path through the maze.
+template <typename Maze>
+path longest_path(const Maze& m)
+{
+    const size_t C = cols(m);
+
+    const coord from = farthest(m, {0, 0}).first;
+    packed_directions parents(rows(m) * C);
+    const coord to = farthest(m, from, &parents).first;
+
+    path p;
+    coord c = to;
+    p.push_back(c);
+    while (!(c == from)) {
+        const auto d = delta(parents.get(c.row * C + c.col));
+        c = {c.row + d.first, c.col + d.second};
+        p.push_back(c);
+    }
+    return p;
+}
+
+} // namespace maze
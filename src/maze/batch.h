@@ -0,0 +1,208 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Find paths for batches of (start, exit) queries on a thread pool.
+///
+/// See README for problem and solution description.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <common/thread-pool.h>
+#include <maze/maze.h>
+
+namespace maze {
+
+/// A path query.
+struct query {
+    coord start;
+    coord exit;
+};
+
+/// Solves batches of path queries on a thread pool.
+///
+/// Queries sharing an exit are answered by a single breadth first search from
+/// the exit, which stops once it has reached all their start rooms. A task per
+/// worker claims exits to search for in turn, so searches for different exits
+/// run in parallel without a task per exit. Each worker reuses its own search
+/// scratch space, sized to the maze, across searches and batches.
+class batch_solver {
+public:
+    /// \param pool The pool to run searches on, which must outlive the solver.
+    explicit batch_solver(common::thread_pool& pool) :
+        pool_(pool),
+        scratch_(pool.size())
+    {}
+
+    /// Find a shortest path for each query.
+    ///
+    /// \param m The maze.
+    /// \param queries The queries.
+    /// \param paths Set to the path for each query, in order, or an empty path
+    ///              for queries whose exit can't be reached.
+    template <typename Maze>
+    void solve(
+            const Maze& m,
+            const std::vector<query>& queries,
+            std::vector<path>& paths);
+
+    /// \return a shortest path for each query.
+    template <typename Maze>
+    std::vector<path> solve(const Maze& m, const std::vector<query>& queries)
+    {
+        std::vector<path> paths;
+        solve(m, queries, paths);
+        return paths;
+    }
+
+private:
+    /// A worker's search state. A room is visited in the current search iff
+    /// its stamp is the epoch, and is a start room yet to be visited iff its
+    /// stamp is the epoch plus 1.
+    struct scratch {
+        std::vector<uint32_t> stamp;
+        std::vector<uint8_t> next;      /// Direction towards the exit.
+        std::vector<uint32_t> queue;
+        uint32_t epoch = 0;
+    };
+
+    template <typename Maze>
+    void search(
+            const Maze& m,
+            const std::vector<query>& queries,
+            size_t first,
+            size_t last,
+            scratch& s,
+            std::vector<path>& paths) const;
+
+    common::thread_pool& pool_;
+    std::vector<scratch> scratch_;
+    std::vector<uint32_t> order_;       /// Query indices ordered by exit.
+    std::vector<size_t> groups_;        /// Where each exit's queries start in
+                                        /// order_, then order_'s size.
+};
+
+template <typename Maze>
+void batch_solver::solve(
+        const Maze& m,
+        const std::vector<query>& queries,
+        std::vector<path>& paths)
+{
+    const size_t C = cols(m);
+    paths.resize(queries.size());
+
+    // Group the queries by exit.
+    order_.resize(queries.size());
+    for (uint32_t i = 0; i < order_.size(); ++i)
+        order_[i] = i;
+    auto exit_index = [&] (const uint32_t i) {
+        return queries[i].exit.row * C + queries[i].exit.col;
+    };
+    std::sort(
+            begin(order_),
+            end(order_),
+            [&] (const uint32_t a, const uint32_t b) {
+                return exit_index(a) < exit_index(b);
+            });
+
+    groups_.clear();
+    for (size_t k = 0; k < order_.size(); ++k)
+        if (k == 0 || exit_index(order_[k]) != exit_index(order_[k - 1]))
+            groups_.push_back(k);
+    groups_.push_back(order_.size());
+
+    // Each task claims groups until none are left. The tasks capture only a
+    // reference, so std::function holds them without allocating.
+    std::atomic<size_t> next(0);
+    auto work = [&] (const size_t w) {
+        for (size_t g; (g = next++) + 1 < groups_.size();)
+            search(m, queries, groups_[g], groups_[g + 1], scratch_[w], paths);
+    };
+    const size_t tasks = std::min(pool_.size(), groups_.size() - 1);
+    for (size_t t = 0; t < tasks; ++t)
+        pool_.submit([&work] (const size_t w) { work(w); });
+    pool_.wait();
+}
+
+/// Answer the queries \c order_[first, last), which share an exit.
+template <typename Maze>
+void batch_solver::search(
+        const Maze& m,
+        const std::vector<query>& queries,
+        const size_t first,
+        const size_t last,
+        scratch& s,
+        std::vector<path>& paths) const
+{
+    const size_t R = rows(m);
+    const size_t C = cols(m);
+    if (s.stamp.size() != R * C) {
+        s.stamp.assign(R * C, 0);
+        s.next.resize(R * C);
+        s.queue.resize(R * C);
+        s.epoch = 0;
+    }
+    if (s.epoch >= UINT32_MAX - 2) {
+        std::fill(begin(s.stamp), end(s.stamp), 0);
+        s.epoch = 0;
+    }
+    s.epoch += 2;
+
+    // Mark the start rooms.
+    const coord exit = queries[order_[first]].exit;
+    size_t remaining = 0;
+    for (size_t k = first; k < last; ++k) {
+        const coord& start = queries[order_[k]].start;
+        uint32_t& stamp = s.stamp[start.row * C + start.col];
+        if (stamp != s.epoch + 1) {
+            stamp = s.epoch + 1;
+            ++remaining;
+        }
+    }
+
+    // Search from the exit until all start rooms are visited.
+    size_t head = 0;
+    size_t tail = 0;
+    auto visit = [&] (const uint32_t i, const uint8_t next) {
+        if (s.stamp[i] == s.epoch + 1)
+            --remaining;
+        s.stamp[i] = s.epoch;
+        s.next[i] = next;
+        s.queue[tail++] = i;
+    };
+    visit(exit.row * C + exit.col, 0);
+    while (head < tail && remaining > 0) {
+        const uint32_t i = s.queue[head++];
+        const auto& room = m[i / C][i % C];
+        for (auto direction : {up, right, down, left}) {
+            if (!room.has_door(direction))
+                continue;
+            const auto d = delta(direction);
+            const uint32_t n = (i / C + d.first) * C + (i % C + d.second);
+            if (s.stamp[n] != s.epoch)
+                visit(n, reverse(direction));
+        }
+    }
+
+    // Follow each start room's directions to the exit.
+    for (size_t k = first; k < last; ++k) {
+        const coord& start = queries[order_[k]].start;
+        path& p = paths[order_[k]];
+        p.clear();
+        uint32_t i = start.row * C + start.col;
+        if (s.stamp[i] != s.epoch)
+            continue;                               // Unreachable.
+        p.push_back(start);
+        while (s.next[i] != 0) {
+            const auto d = delta(static_cast<direction>(s.next[i]));
+            i = (i / C + d.first) * C + (i % C + d.second);
+            p.push_back({i / C, i % C});
+        }
+    }
+}
+
+} // namespace maze
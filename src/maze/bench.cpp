@@ -0,0 +1,104 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Benchmark maze generation, path finding and room storage layouts.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <common/bench.h>
+#include <common/thread-pool.h>
+#include <maze/batch.h>
+#include <maze/find-path.h>
+#include <maze/generate-tiled.h>
+#include <maze/generate.h>
+#include <maze/layout.h>
+#include <maze/lca.h>
+#include <maze/maze.h>
+
+using namespace std;
+using namespace maze;
+using common::bench::harness;
+using common::bench::keep;
+
+/// Benchmark generating and solving an R by C maze.
+template <size_t R, size_t C>
+static void run(harness& h)
+{
+    const string size = to_string(R) + "x" + to_string(C);
+    const coord start = {R - 1, C - 1};
+    const coord exit = {0, 0};
+
+    h.run("generate/" + size, R * C, [&] () {
+        keep(generate<R, C>(exit, 1));
+    });
+
+    const auto m = generate<R, C>(exit, 1);
+    h.run("find_path_iterative/" + size, R * C, [&] () {
+        keep(find_path_iterative(m, start, exit));
+    });
+    h.run("find_path_iterative_stats/" + size, R * C, [&] () {
+        search_stats<common::stats::enabled> stats;
+        keep(find_path_iterative(m, start, exit, stats));
+        keep(stats.expanded.value());
+    });
+    h.run("find_path_recursive/" + size, R * C, [&] () {
+        keep(find_path_recursive(m, start, exit));
+    });
+}
+
+/// Benchmark generating a maze in, and indexing and finding paths through, a
+/// grid \c g.
+template <size_t R, size_t C, typename Grid>
+static void run_layout(harness& h, const string& layout, Grid& g)
+{
+    const string size = to_string(R) + "x" + to_string(C);
+    const coord exit = {R / 2, C / 2};
+    h.run("generate_tiled/" + layout + "/" + size, R * C, [&] () {
+        generate_tiled(g, exit, 1, 1);
+    });
+    h.run("lca_index/" + layout + "/" + size, R * C, [&] () {
+        keep(lca_index<R, C>(g, exit));
+    });
+
+    const Grid& m = g;
+    h.run("find_path_iterative/" + layout + "/" + size, R * C, [&] () {
+        keep(find_path_iterative(m, {0, 0}, exit));
+    });
+
+    // One worker, so only the layout differs, and queries from each corner,
+    // so the search covers most of the maze.
+    common::thread_pool pool(1);
+    batch_solver solver(pool);
+    const vector<query> queries = {
+        {{0, 0}, exit}, {{0, C - 1}, exit},
+        {{R - 1, 0}, exit}, {{R - 1, C - 1}, exit}};
+    vector<path> paths;
+    h.run("batch_solve/" + layout + "/" + size, R * C, [&] () {
+        solver.solve(m, queries, paths);
+        keep(paths);
+    });
+}
+
+/// Benchmark each room storage layout.
+template <size_t R, size_t C>
+static void run_layouts(harness& h)
+{
+    run_layout<R, C>(h, "array", *make_unique<::maze::maze<R, C>>());
+    run_layout<R, C>(h, "row-major", *make_unique<grid<R, C, row_major>>());
+    run_layout<R, C>(h, "tiled-8", *make_unique<grid<R, C, tiled<8>>>());
+    run_layout<R, C>(h, "tiled-32", *make_unique<grid<R, C, tiled<32>>>());
+}
+
+int main(int argc, char** argv)
+{
+    harness h(argc, argv);
+    run<16, 16>(h);
+    run<64, 64>(h);
+    run<128, 128>(h);
+    run_layouts<256, 256>(h);
+    run_layouts<1024, 1024>(h);
+    run_layouts<4096, 4096>(h);
+    return h.finish();
+}
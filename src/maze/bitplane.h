@@ -0,0 +1,304 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Bit-parallel flood fill over door bitplanes.
+///
+/// See README for problem and solution description.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// A maze stored as door bitplanes, one bit per room per plane, for bit-parallel
+/// breadth first exploration.
+///
+/// Doors are bi-directional, so a room's left and up doors are its left and up
+/// neighbours' right and down doors. Only the right and down planes are stored,
+/// halving the memory traffic of each sweep. Each row of a plane is padded to a
+/// whole number of machine words and bit \c c%64 of word \c c/64 of a row
+/// represents column \c c.
+///
+/// A frontier advances a machine word of rooms at a time with shifts, ANDs and
+/// ORs rather than a branch per door.
+template <size_t R, size_t C>
+class bitplanes {
+public:
+    using word_t = uint64_t;
+    using bitset = std::vector<word_t>;     /// A bit per room, row by row.
+
+    constexpr static const size_t WORD_BITS = 64;
+    constexpr static const size_t WORDS = (C + WORD_BITS - 1) / WORD_BITS;
+    constexpr static const uint32_t UNREACHABLE =
+            std::numeric_limits<uint32_t>::max();
+
+    explicit bitplanes(const maze<R, C>& m);
+
+    /// \return the rooms reachable from room \c s.
+    bitset reachable(const coord& s) const;
+
+    /// \return true iff room \c e is reachable from room \c s.
+    bool reachable(const coord& s, const coord& e) const;
+
+    /// \return the number of doors on a shortest path from room \c s to room
+    /// \c e, or \c UNREACHABLE if there's none.
+    uint32_t distance(const coord& s, const coord& e) const;
+
+    /// \return the number of doors on a shortest path from every room, indexed
+    /// row by row, to room \c e, or \c UNREACHABLE for rooms with none.
+    std::vector<uint32_t> distances(const coord& e) const;
+
+    /// \return true iff bit \c c of \c row is set.
+    static bool test(const word_t* const row, const size_t c)
+    {
+        return (row[c / WORD_BITS] >> (c % WORD_BITS)) & 1;
+    }
+
+private:
+    /// Breadth first search state. The frontier spans rows [first, last], or
+    /// is empty if \c first is \c R.
+    struct search {
+        explicit search(const coord& s);
+
+        bitset visited;
+        bitset frontier;
+        bitset next;
+        size_t first;
+        size_t last;
+    };
+
+    void advance(search& s) const;
+    void expand(const bitset& frontier, size_t r, word_t* next) const;
+    void fill_row(size_t r, word_t* row) const;
+    const word_t* down_doors(size_t r) const { return &down_[r * WORDS]; }
+    const word_t* right_doors(size_t r) const { return &right_[r * WORDS]; }
+
+    bitset right_;      /// Rooms with a door to the right.
+    bitset down_;       /// Rooms with a door down.
+};
+
+template <size_t R, size_t C>
+bitplanes<R, C>::bitplanes(const maze<R, C>& m) :
+    right_(R * WORDS, 0),
+    down_(R * WORDS, 0)
+{
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t c = 0; c < C; ++c) {
+            const word_t bit = word_t(1) << (c % WORD_BITS);
+            const size_t w = r * WORDS + c / WORD_BITS;
+            if (m[r][c].has_door(right))
+                right_[w] |= bit;
+            if (m[r][c].has_door(down))
+                down_[w] |= bit;
+        }
+    }
+}
+
+/// Extend the rooms of row \c r through its horizontal doors until no more
+/// rooms can be reached.
+///
+/// Within a word rooms are filled in log(64) steps by doubling the shift
+/// distance (a Kogge-Stone fill). Bits carry between words at word edges.
+template <size_t R, size_t C>
+void bitplanes<R, C>::fill_row(const size_t r, word_t* const row) const
+{
+    const word_t* const doors = right_doors(r);
+
+    // Fill rightwards, carrying the last column of each word into the next.
+    word_t carry = 0;
+    for (size_t w = 0; w < WORDS; ++w) {
+        word_t x = row[w] | carry;
+        word_t p = doors[w];
+        for (size_t s = 1; s < WORD_BITS; s <<= 1) {
+            x |= (x & p) << s;
+            p &= p >> s;
+        }
+        row[w] = x;
+        carry = (x & doors[w]) >> (WORD_BITS - 1);
+    }
+
+    // Fill leftwards, carrying the first column of each word into the last of
+    // the previous.
+    carry = 0;
+    for (size_t w = WORDS; w-- > 0;) {
+        word_t x = row[w] | (carry & doors[w]);
+        word_t p = doors[w];
+        for (size_t s = 1; s < WORD_BITS; s <<= 1) {
+            x |= (x >> s) & p;
+            p &= p >> s;
+        }
+        row[w] = x;
+        carry = (x & 1) << (WORD_BITS - 1);
+    }
+}
+
+/// Set the rooms of row \c r one door away from the \c frontier in \c next.
+template <size_t R, size_t C>
+void bitplanes<R, C>::expand(
+        const bitset& frontier,
+        const size_t r,
+        word_t* const next) const
+{
+    const word_t* const f = &frontier[r * WORDS];
+    const word_t* const doors = right_doors(r);
+    for (size_t w = 0; w < WORDS; ++w) {
+        // Move right from the previous column and left from the next.
+        const word_t from_left =
+                ((f[w] & doors[w]) << 1) |
+                (w > 0 ? (f[w - 1] & doors[w - 1]) >> (WORD_BITS - 1) : 0);
+        const word_t from_right =
+                ((f[w] >> 1) |
+                 (w + 1 < WORDS ? f[w + 1] << (WORD_BITS - 1) : 0)) & doors[w];
+        next[w] = from_left | from_right;
+    }
+    if (r > 0) {
+        // Move down from the previous row.
+        const word_t* const above = &frontier[(r - 1) * WORDS];
+        const word_t* const doors_above = down_doors(r - 1);
+        for (size_t w = 0; w < WORDS; ++w)
+            next[w] |= above[w] & doors_above[w];
+    }
+    if (r + 1 < R) {
+        // Move up from the next row.
+        const word_t* const below = &frontier[(r + 1) * WORDS];
+        const word_t* const doors_here = down_doors(r);
+        for (size_t w = 0; w < WORDS; ++w)
+            next[w] |= below[w] & doors_here[w];
+    }
+}
+
+template <size_t R, size_t C>
+typename bitplanes<R, C>::bitset
+bitplanes<R, C>::reachable(const coord& s) const
+{
+    assert(s.row < R && s.col < C);
+
+    // Sweep down then up the rows, moving through vertical doors from the row
+    // just swept and filling each row through its horizontal doors, until a
+    // pair of sweeps reaches no more rooms.
+    bitset visited(R * WORDS, 0);
+    visited[s.row * WORDS + s.col / WORD_BITS] |=
+            word_t(1) << (s.col % WORD_BITS);
+    fill_row(s.row, &visited[s.row * WORDS]);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t pass = 0; pass < 2; ++pass) {
+            for (size_t i = 1; i < R; ++i) {
+                const size_t r = pass == 0 ? i : R - 1 - i;
+                const size_t from = pass == 0 ? r - 1 : r + 1;
+                const word_t* const doors =
+                        down_doors(pass == 0 ? from : r);
+                word_t* const row = &visited[r * WORDS];
+                const word_t* const source = &visited[from * WORDS];
+                word_t entered = 0;
+                for (size_t w = 0; w < WORDS; ++w)
+                    entered |= source[w] & doors[w] & ~row[w];
+                if (!entered)
+                    continue;
+                for (size_t w = 0; w < WORDS; ++w)
+                    row[w] |= source[w] & doors[w];
+                fill_row(r, row);
+                changed = true;
+            }
+        }
+    }
+    return visited;
+}
+
+template <size_t R, size_t C>
+bool bitplanes<R, C>::reachable(const coord& s, const coord& e) const
+{
+    assert(e.row < R && e.col < C);
+    return test(&reachable(s)[e.row * WORDS], e.col);
+}
+
+template <size_t R, size_t C>
+bitplanes<R, C>::search::search(const coord& s) :
+    visited(R * WORDS, 0),
+    frontier(R * WORDS, 0),
+    next(R * WORDS, 0),
+    first(s.row),
+    last(s.row)
+{
+    frontier[s.row * WORDS + s.col / WORD_BITS] |=
+            word_t(1) << (s.col % WORD_BITS);
+}
+
+/// Advance the search's frontier by a level, expanding only the rows it spans
+/// and their neighbours.
+template <size_t R, size_t C>
+void bitplanes<R, C>::advance(search& s) const
+{
+    size_t first = R;
+    size_t last = 0;
+    const size_t lo = s.first > 0 ? s.first - 1 : 0;
+    const size_t hi = s.last + 1 < R ? s.last + 1 : R - 1;
+    for (size_t r = lo; r <= hi; ++r) {
+        word_t* const n = &s.next[r * WORDS];
+        word_t* const v = &s.visited[r * WORDS];
+        const word_t* const f = &s.frontier[r * WORDS];
+        expand(s.frontier, r, n);
+        word_t any = 0;
+        for (size_t w = 0; w < WORDS; ++w) {
+            v[w] |= f[w];
+            n[w] &= ~v[w];
+            any |= n[w];
+        }
+        if (any) {
+            first = std::min(first, r);
+            last = r;
+        }
+    }
+
+    // Clear the old frontier's rows so it can be reused for the next level.
+    std::fill(
+            begin(s.frontier) + lo * WORDS,
+            begin(s.frontier) + (hi + 1) * WORDS,
+            0);
+    s.frontier.swap(s.next);
+    s.first = first;
+    s.last = last;
+}
+
+template <size_t R, size_t C>
+uint32_t bitplanes<R, C>::distance(const coord& s, const coord& e) const
+{
+    assert(s.row < R && s.col < C && e.row < R && e.col < C);
+
+    search bfs(s);
+    for (uint32_t level = 0; bfs.first < R; ++level) {
+        if (test(&bfs.frontier[e.row * WORDS], e.col))
+            return level;
+        advance(bfs);
+    }
+    return UNREACHABLE;
+}
+
+template <size_t R, size_t C>
+std::vector<uint32_t> bitplanes<R, C>::distances(const coord& e) const
+{
+    assert(e.row < R && e.col < C);
+
+    std::vector<uint32_t> ds(R * C, UNREACHABLE);
+    search bfs(e);
+    for (uint32_t level = 0; bfs.first < R; ++level) {
+        // Record the frontier's distance, then advance it.
+        for (size_t r = bfs.first; r <= bfs.last; ++r) {
+            for (size_t w = 0; w < WORDS; ++w) {
+                for (word_t f = bfs.frontier[r * WORDS + w]; f; f &= f - 1)
+                    ds[r * C + w * WORD_BITS + __builtin_ctzll(f)] = level;
+            }
+        }
+        advance(bfs);
+    }
+    return ds;
+}
+
+} // namespace maze
@@ -0,0 +1,228 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Maintain paths to the exit of a maze as its doors are opened and closed.
+///
+/// See README for problem and solution description.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// A maze whose doors may be opened and closed while a shortest path tree to
+/// its exit, i.e. each room's distance to the exit and next room towards it,
+/// is kept up to date incrementally.
+///
+/// Opening a door that shortens a room's path re-searches only the rooms whose
+/// paths shorten. Closing a door on the tree re-searches only the rooms whose
+/// paths ran through it.
+template <size_t R, size_t C>
+class dynamic_maze {
+public:
+    constexpr static const uint32_t UNREACHABLE =
+            std::numeric_limits<uint32_t>::max();
+
+    /// Build the shortest path tree by a breadth first search from the exit.
+    ///
+    /// \param m The maze, which must outlive this object and only have doors
+    ///          opened and closed through it.
+    /// \param exit The exit room's co-ordinates.
+    dynamic_maze(maze<R, C>& m, const coord& exit);
+
+    /// Open the door of room \c c in direction \c d, and its reverse.
+    void open_door(const coord& c, direction d);
+
+    /// Close the door of room \c c in direction \c d, and its reverse.
+    void close_door(const coord& c, direction d);
+
+    /// \return the number of doors on a shortest path from room \c c to the
+    /// exit, or \c UNREACHABLE if there's none.
+    uint32_t distance(const coord& c) const
+    {
+        assert(c.row < R && c.col < C);
+        return distance_[index(c)];
+    }
+
+    /// \return a shortest path from room \c start to the exit, or an empty path
+    /// if there's none.
+    path find_path(const coord& start) const;
+
+    const maze<R, C>& get() const { return m_; }
+    coord exit() const { return exit_; }
+
+private:
+    using entry = std::pair<uint32_t, uint32_t>;   /// Distance, room index.
+
+    coord coordinate(const uint32_t i) const { return {i / C, i % C}; }
+    uint32_t index(const coord& c) const { return c.row * C + c.col; }
+    uint32_t neighbour(uint32_t i, direction d) const;
+    void relax();
+
+    maze<R, C>& m_;
+    coord exit_;
+    std::vector<uint32_t> distance_;
+    std::vector<uint8_t> next_;         /// Direction towards the exit, or 0.
+
+    // Scratch space reused across edits.
+    std::vector<uint32_t> affected_;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue_;
+};
+
+template <size_t R, size_t C>
+dynamic_maze<R, C>::dynamic_maze(maze<R, C>& m, const coord& exit) :
+    m_(m),
+    exit_(exit),
+    distance_(R * C, UNREACHABLE),
+    next_(R * C, 0)
+{
+    assert(exit.row < R && exit.col < C);
+
+    distance_[index(exit)] = 0;
+    queue_.push({0, index(exit)});
+    relax();
+}
+
+template <size_t R, size_t C>
+uint32_t dynamic_maze<R, C>::neighbour(const uint32_t i, const direction d) const
+{
+    const auto move = delta(d);
+    return index({i / C + move.first, i % C + move.second});
+}
+
+/// Settle the rooms in the queue, in order of distance, and any rooms whose
+/// paths shorten through them.
+template <size_t R, size_t C>
+void dynamic_maze<R, C>::relax()
+{
+    while (!queue_.empty()) {
+        const entry e = queue_.top();
+        queue_.pop();
+        if (e.first != distance_[e.second])
+            continue;                               // Stale entry.
+
+        const coord c = coordinate(e.second);
+        const room& room = m_[c.row][c.col];
+        for (auto direction : {up, right, down, left}) {
+            if (!room.has_door(direction))
+                continue;
+            const uint32_t n = neighbour(e.second, direction);
+            if (e.first + 1 < distance_[n]) {
+                distance_[n] = e.first + 1;
+                next_[n] = reverse(direction);
+                queue_.push({e.first + 1, n});
+            }
+        }
+    }
+}
+
+template <size_t R, size_t C>
+void dynamic_maze<R, C>::open_door(const coord& c, const direction d)
+{
+    const auto move = delta(d);
+    const coord o = {c.row + move.first, c.col + move.second};
+    assert(c.row < R && c.col < C && o.row < R && o.col < C);
+
+    m_[c.row][c.col].add_door(d);
+    m_[o.row][o.col].add_door(reverse(d));
+
+    // Only the room further from the exit, and rooms beyond it, may get closer.
+    const uint32_t i = index(c);
+    const uint32_t j = index(o);
+    if (distance_[i] != UNREACHABLE && distance_[i] + 1 < distance_[j]) {
+        distance_[j] = distance_[i] + 1;
+        next_[j] = reverse(d);
+        queue_.push({distance_[j], j});
+    } else if (distance_[j] != UNREACHABLE && distance_[j] + 1 < distance_[i]) {
+        distance_[i] = distance_[j] + 1;
+        next_[i] = d;
+        queue_.push({distance_[i], i});
+    }
+    relax();
+}
+
+template <size_t R, size_t C>
+void dynamic_maze<R, C>::close_door(const coord& c, const direction d)
+{
+    const auto move = delta(d);
+    const coord o = {c.row + move.first, c.col + move.second};
+    assert(c.row < R && c.col < C && o.row < R && o.col < C);
+
+    m_[c.row][c.col].remove_door(d);
+    m_[o.row][o.col].remove_door(reverse(d));
+
+    // Only if the door is on the tree do paths change: those of the room on
+    // the far side from the exit and the rooms whose paths run through it.
+    uint32_t root;
+    if (next_[index(c)] == d)
+        root = index(c);
+    else if (next_[index(o)] == reverse(d))
+        root = index(o);
+    else
+        return;
+
+    // Find the subtree, whose paths are invalidated.
+    affected_.clear();
+    affected_.push_back(root);
+    for (size_t k = 0; k < affected_.size(); ++k) {
+        const uint32_t i = affected_[k];
+        const coord ci = coordinate(i);
+        for (auto direction : {up, right, down, left}) {
+            if (!m_[ci.row][ci.col].has_door(direction))
+                continue;
+            const uint32_t n = neighbour(i, direction);
+            if (next_[n] == reverse(direction))
+                affected_.push_back(n);
+        }
+    }
+    for (const auto i : affected_) {
+        distance_[i] = UNREACHABLE;
+        next_[i] = 0;
+    }
+
+    // Re-search the subtree from its unaffected neighbours.
+    for (const auto i : affected_) {
+        const coord ci = coordinate(i);
+        for (auto direction : {up, right, down, left}) {
+            if (!m_[ci.row][ci.col].has_door(direction))
+                continue;
+            const uint32_t n = neighbour(i, direction);
+            if (distance_[n] != UNREACHABLE &&
+                    distance_[n] + 1 < distance_[i]) {
+                distance_[i] = distance_[n] + 1;
+                next_[i] = direction;
+            }
+        }
+        if (distance_[i] != UNREACHABLE)
+            queue_.push({distance_[i], i});
+    }
+    relax();
+}
+
+template <size_t R, size_t C>
+path dynamic_maze<R, C>::find_path(const coord& start) const
+{
+    assert(start.row < R && start.col < C);
+
+    if (distance_[index(start)] == UNREACHABLE)
+        return {};
+
+    path p;
+    uint32_t i = index(start);
+    p.push_back(start);
+    while (distance_[i] != 0) {
+        i = neighbour(i, static_cast<direction>(next_[i]));
+        p.push_back(coordinate(i));
+    }
+    return p;
+}
+
+} // namespace maze
@@ -0,0 +1,308 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Save and load mazes in a compact binary format.
+///
+/// See README for the format description.
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// Binary maze file header.
+///
+/// A file is a header of \c SIZE bytes followed by a nibble of door bits per
+/// room, row by row. The first of each pair of rooms is in the low nibble of a
+/// byte and the second in the high nibble. Integers are little endian.
+///
+///     offset  size  field
+///     0       4     magic "MAZE"
+///     4       4     version
+///     8       8     rows
+///     16      8     columns
+///     24      8     exit row, or rows if the maze has no exit
+///     32      8     exit column, or columns if the maze has no exit
+struct file_header {
+    constexpr static const size_t SIZE = 40;
+    constexpr static const uint32_t VERSION = 1;
+
+    uint32_t version;
+    uint64_t rows;
+    uint64_t cols;
+    coord exit;
+
+    /// \return the number of bytes of door bits following the header.
+    uint64_t doors_size() const
+    {
+        const uint64_t rooms = rows * cols;
+        return rooms / 2 + rooms % 2;
+    }
+
+    /// Encode the header into \c SIZE bytes at \c out.
+    void encode(uint8_t* out) const;
+
+    /// \return the header decoded from \c SIZE bytes at \c in.
+    /// \exception \c std::runtime_error if the bytes aren't a valid header.
+    static file_header decode(const uint8_t* in);
+};
+
+void file_header::encode(uint8_t* const out) const
+{
+    auto put = [out] (const size_t offset, const size_t size, uint64_t v) {
+        for (size_t i = 0; i < size; ++i, v >>= 8)
+            out[offset + i] = static_cast<uint8_t>(v);
+    };
+    std::memcpy(out, "MAZE", 4);
+    put(4, 4, version);
+    put(8, 8, rows);
+    put(16, 8, cols);
+    put(24, 8, exit.row);
+    put(32, 8, exit.col);
+}
+
+file_header file_header::decode(const uint8_t* const in)
+{
+    auto get = [in] (const size_t offset, const size_t size) {
+        uint64_t v = 0;
+        for (size_t i = size; i-- > 0;)
+            v = (v << 8) | in[offset + i];
+        return v;
+    };
+    if (std::memcmp(in, "MAZE", 4) != 0)
+        throw std::runtime_error("not a maze file");
+
+    file_header h;
+    h.version = static_cast<uint32_t>(get(4, 4));
+    h.rows = get(8, 8);
+    h.cols = get(16, 8);
+    h.exit = {get(24, 8), get(32, 8)};
+    if (h.version != VERSION)
+        throw std::runtime_error("unsupported maze file version");
+    // The rooms, and a room index one past them, must fit in 64 bits.
+    if (h.cols != 0 && h.rows >= UINT64_MAX / h.cols)
+        throw std::runtime_error("invalid maze file dimensions");
+    return h;
+}
+
+/// Check no room on the border of a maze read from a file has a door leading
+/// off the grid, which path finding would follow out of bounds. Only border
+/// rooms can, so this takes O(rows + cols).
+///
+/// \param doors A function of a row and column returning the door bits of
+///              the room there.
+/// \exception \c std::runtime_error if a door leads off the grid.
+template <typename Doors>
+void check_border(const uint64_t rows, const uint64_t cols, Doors doors)
+{
+    if (rows == 0 || cols == 0)
+        return;
+    for (uint64_t c = 0; c < cols; ++c)
+        if ((doors(0, c) & up) || (doors(rows - 1, c) & down))
+            throw std::runtime_error("maze file door leads off the grid");
+    for (uint64_t r = 0; r < rows; ++r)
+        if ((doors(r, 0) & left) || (doors(r, cols - 1) & right))
+            throw std::runtime_error("maze file door leads off the grid");
+}
+
+/// Save a maze to a file.
+///
+/// Only doors and the exit are saved, not paths.
+///
+/// \param m The maze to save.
+/// \param filename The file to create or overwrite.
+/// \exception \c std::runtime_error if the file can't be written.
+template <size_t R, size_t C>
+void save(const maze<R, C>& m, const std::string& filename)
+{
+    file_header h = {file_header::VERSION, R, C, {R, C}};
+    for (size_t r = 0; r < R && h.exit.row == R; ++r)
+        for (size_t c = 0; c < C; ++c)
+            if (m[r][c].exit())
+                h.exit = {r, c};
+
+    std::ofstream os(filename, std::ios::binary | std::ios::trunc);
+    uint8_t header[file_header::SIZE];
+    h.encode(header);
+    os.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    // Pack door nibbles a block at a time.
+    constexpr size_t BLOCK = 1 << 16;
+    std::vector<uint8_t> block;
+    block.reserve(BLOCK);
+    uint8_t byte = 0;
+    for (size_t i = 0; i < R * C; ++i) {
+        const uint8_t doors = m[i / C][i % C].doors();
+        if (i % 2 == 0) {
+            byte = doors;
+        } else {
+            block.push_back(byte | (doors << 4));
+            if (block.size() == BLOCK) {
+                os.write(reinterpret_cast<const char*>(block.data()), BLOCK);
+                block.clear();
+            }
+        }
+    }
+    if ((R * C) % 2 != 0)
+        block.push_back(byte);
+    os.write(reinterpret_cast<const char*>(block.data()), block.size());
+
+    if (!os)
+        throw std::runtime_error("failed to write maze file " + filename);
+}
+
+/// Load a maze from a file.
+///
+/// \param filename The file to read.
+/// \param m The maze to load into. Paths are cleared.
+/// \exception \c std::runtime_error if the file can't be read, isn't a valid
+/// maze file, e.g. a door leads off the grid, or its dimensions aren't R by C.
+template <size_t R, size_t C>
+void load(const std::string& filename, maze<R, C>& m)
+{
+    std::ifstream is(filename, std::ios::binary);
+    uint8_t header[file_header::SIZE];
+    if (!is.read(reinterpret_cast<char*>(header), sizeof(header)))
+        throw std::runtime_error("failed to read maze file " + filename);
+    const file_header h = file_header::decode(header);
+    if (h.rows != R || h.cols != C)
+        throw std::runtime_error("maze file dimensions mismatch");
+
+    // Unpack door nibbles a block at a time.
+    constexpr size_t BLOCK = 1 << 16;
+    std::vector<uint8_t> block(BLOCK);
+    for (size_t i = 0; i < R * C; i += 2 * BLOCK) {
+        const size_t n = std::min(BLOCK, (R * C - i + 1) / 2);
+        if (!is.read(reinterpret_cast<char*>(block.data()), n))
+            throw std::runtime_error("truncated maze file " + filename);
+        for (size_t j = 0; j < 2 * n && i + j < R * C; ++j) {
+            room& room = m[(i + j) / C][(i + j) % C];
+            room = ::maze::room();
+            room.doors((block[j / 2] >> (4 * (j % 2))) & 0xf);
+        }
+    }
+    check_border(R, C, [&m] (const size_t r, const size_t c) {
+        return m[r][c].doors();
+    });
+    if (h.exit.row < R && h.exit.col < C)
+        m[h.exit.row][h.exit.col].exit(true);
+}
+
+/// A read-only view of a maze file mapped into memory.
+///
+/// Mapping is constant time regardless of maze size; pages are read on demand
+/// as rooms are accessed. Rooms are accessed as for a \c maze, i.e. \c m[r][c],
+/// but by value, so the view may be passed to the path finding functions.
+class mapped_maze {
+public:
+    /// A row of rooms.
+    class row {
+    public:
+        row(const mapped_maze& m, const size_t r) : m_(m), r_(r) {}
+
+        /// \return the room in column \c c.
+        room operator[](const size_t c) const
+        {
+            room room;
+            room.doors(m_.doors(r_, c));
+            room.exit(r_ == m_.exit().row && c == m_.exit().col);
+            return room;
+        }
+
+    private:
+        const mapped_maze& m_;
+        const size_t r_;
+    };
+
+    /// Map a maze file.
+    ///
+    /// \exception \c std::system_error if the file can't be mapped.
+    /// \exception \c std::runtime_error if the file isn't a valid maze file,
+    ///            e.g. a door leads off the grid.
+    explicit mapped_maze(const std::string& filename);
+    mapped_maze(const mapped_maze&) = delete;
+    mapped_maze& operator=(const mapped_maze&) = delete;
+    ~mapped_maze() { munmap(map_, size_); }
+
+    size_t rows() const { return header_.rows; }
+    size_t cols() const { return header_.cols; }
+    coord exit() const { return header_.exit; }
+
+    /// \return the door bits of the room at row \c r and column \c c.
+    uint8_t doors(const size_t r, const size_t c) const
+    {
+        assert(r < rows() && c < cols());
+        const size_t i = r * cols() + c;
+        return (doors_[i / 2] >> (4 * (i % 2))) & 0xf;
+    }
+
+    /// \return the row \c r.
+    row operator[](const size_t r) const { return row(*this, r); }
+
+private:
+    void* map_;
+    size_t size_;
+    file_header header_;
+    const uint8_t* doors_;
+};
+
+/// \return the number of rows of rooms of a mapped maze.
+size_t rows(const mapped_maze& m) { return m.rows(); }
+
+/// \return the number of columns of rooms of a mapped maze.
+size_t cols(const mapped_maze& m) { return m.cols(); }
+
+mapped_maze::mapped_maze(const std::string& filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        const int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), filename);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ < file_header::SIZE) {
+        close(fd);
+        throw std::runtime_error("truncated maze file " + filename);
+    }
+    map_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (map_ == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), filename);
+
+    try {
+        const uint8_t* const bytes = static_cast<const uint8_t*>(map_);
+        header_ = file_header::decode(bytes);
+        if (size_ - file_header::SIZE < header_.doors_size())
+            throw std::runtime_error("truncated maze file " + filename);
+        doors_ = bytes + file_header::SIZE;
+        check_border(rows(), cols(), [this] (const size_t r, const size_t c) {
+            return doors(r, c);
+        });
+    } catch (...) {
+        munmap(map_, size_);
+        throw;
+    }
+}
+
+} // namespace maze
@@ -7,29 +7,47 @@
 
 #pragma once
 
-#include <set>
-#include <stack>
+#include <vector>
 
+#include <common/stats.h>
 #include <maze/maze.h>
 
 namespace maze {
 
+/// Counts of the work of a path search.
+template <typename Policy = common::stats::disabled>
+struct search_stats {
+    typename Policy::counter expanded;  /// Rooms whose doors were explored.
+};
+
 // Forward declaration.
-template <size_t R, size_t C>
-path find_path_iterative(const maze<R, C>&, const coord&, const coord&);
-template <size_t R, size_t C>
-path find_path_recursive(const maze<R, C>&, const coord&, const coord&);
+template <typename Maze>
+path find_path_iterative(const Maze&, const coord&, const coord&);
+template <typename Maze>
+path find_path_recursive(const Maze&, const coord&, const coord&);
+template <typename Maze, typename Policy>
+path find_path_iterative(
+        const Maze&, const coord&, const coord&, search_stats<Policy>&);
+template <typename Maze, typename Policy>
+path find_path_recursive(
+        const Maze&, const coord&, const coord&, search_stats<Policy>&);
+template <typename Maze, typename Policy>
+bool find_path_recursive_(
+        const Maze&, const coord&, const coord&, std::vector<bool>&, path&,
+        search_stats<Policy>&);
 
 /// Find a path to the exit starting at the specified room using DFS.
 ///
+/// \tparam Maze A \c maze, or any type whose rooms are accessed likewise, i.e.
+///              \c m[row][col], such as a \c mapped_maze.
 /// \param m The maze to explore.
 /// \param s The start room co-ordinates.
 /// \param e The exit room co-ordinates.
 /// \return the path to the exit from the specified start.
 ///
 /// \note Alias either recursive or iteration implementation.
-template <size_t R, size_t C>
-path find_path(const maze<R, C>& m, const coord& s, const coord& e)
+template <typename Maze>
+path find_path(const Maze& m, const coord& s, const coord& e)
 {
     return find_path_iterative(m, s, e);
 }
@@ -38,51 +56,67 @@ path find_path(const maze<R, C>& m, const coord& s, const coord& e)
 /// using iteration.
 ///
 /// \see \c find_path
-template <size_t R, size_t C>
-path find_path_iterative(const maze<R, C>& maze, const coord& start, const coord& exit)
+template <typename Maze>
+path find_path_iterative(const Maze& maze, const coord& start, const coord& exit)
+{
+    search_stats<> stats;
+    return find_path_iterative(maze, start, exit, stats);
+}
+
+/// \copydoc find_path_iterative
+///
+/// \param stats Records the rooms expanded.
+template <typename Maze, typename Policy>
+path find_path_iterative(
+        const Maze& maze,
+        const coord& start,
+        const coord& exit,
+        search_stats<Policy>& stats)
 {
     using namespace std;
 
-    // A stack entry consists of the co-ordinates of the rooms to explore and
-    // the path to their predecessor.
+    // A stack entry consists of the co-ordinates of a room to explore and the
+    // length of the path to its predecessor. The path is kept once, and cut
+    // back to a room's predecessor before the room is added, as every room
+    // pushed after the predecessor was added has since been explored.
     struct entry {
-        ::maze::path path;
-        list<coord> coordinates;
+        ::maze::coord coord;
+        size_t depth;
     };
 
-    set<coord> visited;
-    stack<entry> stack;
-    stack.push({{}, {start}});
+    // Visited rooms are a bit per room, allocated once, and the stack and
+    // path grow geometrically, so the search doesn't allocate per step.
+    const size_t C = cols(maze);
+    vector<bool> visited(rows(maze) * C);
+    path p;
+    vector<entry> stack;
+    stack.push_back({start, 0});
     while (!stack.empty()) {
-        const struct entry entry = move(stack.top());
-        stack.pop();
-        for (const auto& coord : entry.coordinates) {
-            if (visited.find(coord) != end(visited))
+        const struct entry entry = stack.back();
+        stack.pop_back();
+        const auto& coord = entry.coord;
+        if (visited[coord.row * C + coord.col])
+            continue;
+        else
+            visited[coord.row * C + coord.col] = true;
+
+        while (p.size() > entry.depth)
+            p.pop_back();
+        p.push_back(coord);
+        if (coord == exit)
+            return p;                                       // Found!
+
+        ++stats.expanded;
+
+        // Push the current room's neighbours, in reverse so the first
+        // direction is explored first.
+        const auto& room = maze[coord.row][coord.col];
+        for (auto direction : {left, down, right, up}) {
+            if (!room.has_door(direction))
                 continue;
-            else
-                visited.insert(coord);
-
-            if (coord == exit) {
-                // Found!
-                path solution = move(entry.path);
-                solution.push_back(coord);
-                return solution;
-            }
-
-            // Create a stack entry to explore the current room's neigbours.
-            // The entry must contain the path to the current room and a list of
-            // coordinates to the current room's neighbours.
-            struct entry next_entry = {entry.path, {}};
-            next_entry.path.push_back(coord);
-            const auto& room = maze[coord.row][coord.col];
-            for (auto direction : {up, right, down, left}) {
-                if (!room.has_door(direction))
-                    continue;
-                auto d = delta(direction);
-                struct coord next_coord = {coord.row + d.first, coord.col + d.second};
-                next_entry.coordinates.emplace_back(next_coord);
-            }
-            stack.emplace(move(next_entry));
+            auto d = delta(direction);
+            struct coord next_coord = {coord.row + d.first, coord.col + d.second};
+            stack.push_back({next_coord, p.size()});
         }
     }
 
@@ -95,28 +129,52 @@ path find_path_iterative(const maze<R, C>& maze, const coord& start, const coord
 /// \note Maze size limited by call stack size.
 ///
 /// \see \c find_path
-template <size_t R, size_t C>
-path find_path_recursive(const maze<R, C>& m, const coord& s, const coord& e)
+template <typename Maze>
+path find_path_recursive(const Maze& m, const coord& s, const coord& e)
 {
-    std::set<coord> visited;
-    return find_path_recursive_(m, s, e, visited);
+    search_stats<> stats;
+    return find_path_recursive(m, s, e, stats);
 }
 
-template <size_t R, size_t C>
-path find_path_recursive_(
-        const maze<R, C>& maze,
+/// \copydoc find_path_recursive
+///
+/// \param stats Records the rooms expanded.
+template <typename Maze, typename Policy>
+path find_path_recursive(
+        const Maze& m,
+        const coord& s,
+        const coord& e,
+        search_stats<Policy>& stats)
+{
+    std::vector<bool> visited(rows(m) * cols(m));
+    path p;
+    find_path_recursive_(m, s, e, visited, p, stats);
+    return p;
+}
+
+/// Extend path \c p from the specified room to the exit, if possible.
+///
+/// \return true iff the exit was found, and \c p is the path to it.
+template <typename Maze, typename Policy>
+bool find_path_recursive_(
+        const Maze& maze,
         const coord& current,
         const coord& exit,
-        std::set<coord>& visited)
+        std::vector<bool>& visited,
+        path& p,
+        search_stats<Policy>& stats)
 {
     const room& room = maze[current.row][current.col];
-    if (visited.find(current) != std::end(visited))
-        return {};                                                  // Stop, pop and backtrack.
+    const size_t i = current.row * cols(maze) + current.col;
+    if (visited[i])
+        return false;                                               // Stop, pop and backtrack.
     else
-        visited.insert(current);
+        visited[i] = true;
 
+    p.push_back(current);
     if (current == exit)
-        return {current};                                           // Found, stop and pop.
+        return true;                                                // Found, stop and pop.
+    ++stats.expanded;
 
     for (auto direction : {up, right, down, left}) {
         if (!room.has_door(direction))
@@ -125,15 +183,12 @@ path find_path_recursive_(
         const auto d = delta(direction);
         const coord next = {current.row + d.first, current.col + d.second};
 
-        path p = find_path_recursive_(maze, next, exit, visited);   // Recurse.
-        if (!p.empty()) {
-            // Done. The recursive call found the exit and returned a path.
-            p.push_front(current);
-            return p;
-        }
+        if (find_path_recursive_(maze, next, exit, visited, p, stats))  // Recurse.
+            return true;        // Done. The recursive call found the exit.
     }
 
-    return {};
+    p.pop_back();                                                   // Backtrack.
+    return false;
 }
 
 } // namespace maze
@@ -0,0 +1,172 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Generate a maze in a grid in parallel, a tile at a time.
+///
+/// See README description.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// Explore a \c rows by \c cols grid depth first, in random order, from cell
+/// \c start, calling \c link(i, d) for each move from cell \c i (numbered row
+/// by row) in direction \c d to an unvisited cell. The moves form a spanning
+/// tree of the grid.
+///
+/// \note The exploration is iterative, so grid size isn't limited by call stack
+/// size.
+template <typename Generator, typename Link>
+void explore(
+        const size_t rows,
+        const size_t cols,
+        const size_t start,
+        Generator& generator,
+        Link link)
+{
+    struct frame {
+        size_t cell;
+        std::array<direction, 4> directions;
+        size_t next;
+    };
+
+    std::vector<bool> visited(rows * cols, false);
+    std::vector<frame> stack;
+    visited[start] = true;
+    stack.push_back({start, get_shuffled_directions(generator), 0});
+    while (!stack.empty()) {
+        frame& f = stack.back();
+        if (f.next == f.directions.size()) {
+            stack.pop_back();                       // Backtrack.
+            continue;
+        }
+
+        // Only visit a valid, unvisited neighbour.
+        const auto direction = f.directions[f.next++];
+        const auto d = delta(direction);
+        const size_t r = f.cell / cols + d.first;
+        const size_t c = f.cell % cols + d.second;
+        if (!(r < rows && c < cols) || visited[r * cols + c])
+            continue;
+
+        visited[r * cols + c] = true;
+        link(f.cell, direction);
+        stack.push_back(
+                {r * cols + c, get_shuffled_directions(generator), 0});
+    }
+}
+
+/// Generate a maze in a grid using multiple threads.
+///
+/// The grid is divided into tiles of \c tile by \c tile rooms. A maze is
+/// generated in each tile, by a pool of threads, with a random generator
+/// seeded per tile. The tile mazes are then joined by a door across the seam
+/// of each pair of tiles adjacent in a random spanning tree of the tiles. The
+/// result is a perfect maze, i.e. a spanning tree of the rooms.
+///
+/// The maze depends only on \c seed and \c tile, not the number of threads.
+///
+/// \tparam Generator A random number generator producing 64 bit numbers and
+///                   constructible from a 64 bit seed.
+/// \tparam Maze A \c maze, or any type whose rooms are accessed likewise, i.e.
+///              \c m[row][col], such as a \c grid.
+/// \param m The grid to generate the maze in. Existing doors are removed.
+/// \param exit The exit room's co-ordinates.
+/// \param seed The random seed.
+/// \param threads The number of threads, or 0 for the hardware concurrency.
+/// \param tile The width and height in rooms of the tiles.
+template <typename Generator = xoshiro256, typename Maze>
+void generate_tiled(
+        Maze& m,
+        const coord& exit,
+        const uint64_t seed,
+        size_t threads = 0,
+        const size_t tile = 64)
+{
+    const size_t R = rows(m);
+    const size_t C = cols(m);
+    assert(exit.row < R && exit.col < C);
+    assert(tile > 0);
+
+    const size_t tile_rows = (R + tile - 1) / tile;
+    const size_t tile_cols = (C + tile - 1) / tile;
+    const size_t tiles = tile_rows * tile_cols;
+
+    // Generate each tile's maze. Tiles are claimed in order from a shared
+    // counter and each thread writes only to the rooms of its tiles.
+    std::atomic<size_t> next(0);
+    auto worker = [&] () {
+        for (size_t t = next++; t < tiles; t = next++) {
+            const size_t r0 = (t / tile_cols) * tile;
+            const size_t c0 = (t % tile_cols) * tile;
+            const size_t rows = std::min(tile, R - r0);
+            const size_t cols = std::min(tile, C - c0);
+            for (size_t r = r0; r < r0 + rows; ++r)
+                for (size_t c = c0; c < c0 + cols; ++c)
+                    m[r][c] = room();
+
+            Generator generator(mix_seed(seed, t));
+            explore(
+                    rows,
+                    cols,
+                    0,
+                    generator,
+                    [&] (const size_t i, const direction d) {
+                        const size_t r = r0 + i / cols;
+                        const size_t c = c0 + i % cols;
+                        const auto move = delta(d);
+                        m[r][c].add_door(d);
+                        m[r + move.first][c + move.second].add_door(
+                                reverse(d));
+                    });
+        }
+    };
+    if (threads == 0)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    threads = std::min(threads, tiles);
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+
+    // Join adjacent tiles along a spanning tree of the tiles with a door at a
+    // random room on their shared seam.
+    Generator generator(mix_seed(seed, tiles));
+    explore(
+            tile_rows,
+            tile_cols,
+            0,
+            generator,
+            [&] (const size_t t, const direction d) {
+                const size_t r0 = (t / tile_cols) * tile;
+                const size_t c0 = (t % tile_cols) * tile;
+                const size_t rows = std::min(tile, R - r0);
+                const size_t cols = std::min(tile, C - c0);
+                coord seam;
+                if (d == up || d == down) {
+                    const size_t c = c0 + generator() % cols;
+                    seam = {d == up ? r0 : r0 + rows - 1, c};
+                } else {
+                    const size_t r = r0 + generator() % rows;
+                    seam = {r, d == left ? c0 : c0 + cols - 1};
+                }
+                const auto move = delta(d);
+                m[seam.row][seam.col].add_door(d);
+                m[seam.row + move.first][seam.col + move.second].add_door(
+                        reverse(d));
+            });
+
+    m[exit.row][exit.col].exit(true);
+}
+
+} // namespace maze
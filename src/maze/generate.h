@@ -7,37 +7,67 @@
 
 #pragma once
 
+#include <cstdint>
+#include <random>
+#include <set>
+
 #include <maze/maze.h>
 
 namespace maze {
 
 // Forward declaration.
-template <size_t R, size_t C> void generate_rec(maze<R, C>&, size_t, size_t);
+template <size_t R, size_t C, typename Generator>
+void generate_rec(maze<R, C>&, const coord&, std::set<coord>&, Generator&);
 
 /// Generate a maze in a R(ows) by C(olumns) grid.
 ///
+/// The same \c seed always generates the same maze.
+///
+/// \tparam Generator A random number generator producing 64 bit numbers and
+///                   constructible from a 64 bit seed.
 /// \param exit the exit room's co-ordinates.
+/// \param seed the random seed.
 /// \return a grid containing the generated maze.
-template <size_t R, size_t C>
-maze<R, C> generate(const coord& exit)
+template <size_t R, size_t C, typename Generator = xoshiro256>
+maze<R, C> generate(const coord& exit, const uint64_t seed)
 {
     assert(exit.row < R && exit.col < C);
 
     maze<R, C> m;
     m[exit.row][exit.col].exit(true);
     std::set<coord> visited;
-    generate_rec(m, exit, visited);
+    Generator generator(seed);
+    generate_rec(m, exit, visited, generator);
     return m;
 }
 
+/// Generate a maze in a R(ows) by C(olumns) grid from a random seed.
+///
+/// \param exit the exit room's co-ordinates.
+/// \return a grid containing the generated maze.
+template <size_t R, size_t C>
+maze<R, C> generate(const coord& exit)
+{
+    std::random_device device;
+    return generate<R, C>(
+            exit,
+            (static_cast<uint64_t>(device()) << 32) | device());
+}
+
 /// Generate a maze using recursive exploration and backtracking.
 ///
 /// \param m the maze grid.
 /// \param current the co-ordinates of the current room.
-template <size_t R, size_t C>
-void generate_rec(maze<R, C>& m, const coord& current, std::set<coord>& visited)
+/// \param visited the co-ordinates of the rooms visited.
+/// \param generator the random number generator.
+template <size_t R, size_t C, typename Generator>
+void generate_rec(
+        maze<R, C>& m,
+        const coord& current,
+        std::set<coord>& visited,
+        Generator& generator)
 {
-    const auto directions = get_shuffled_directions();
+    const auto directions = get_shuffled_directions(generator);
     room& current_room = m[current.row][current.col];
     visited.insert(current);
 
@@ -65,7 +95,7 @@ void generate_rec(maze<R, C>& m, const coord& current, std::set<coord>& visited)
         next_room.add_door(reverse(direction));
 
         // Recurse ...
-        generate_rec(m, next, visited);
+        generate_rec(m, next, visited, generator);
     }
 }
 
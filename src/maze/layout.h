@@ -0,0 +1,114 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Maze grids with a choice of room storage layout.
+///
+/// See README description.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// Rooms are stored row by row, as in a \c maze. Vertical neighbours are a row
+/// apart.
+struct row_major {
+    /// \return the number of rooms stored for an \c rows by \c cols grid.
+    static size_t size(const size_t rows, const size_t cols)
+    {
+        return rows * cols;
+    }
+
+    /// \return the storage index of room (r, c) in a grid of \c cols columns.
+    static size_t index(const size_t r, const size_t c, const size_t cols)
+    {
+        return r * cols + c;
+    }
+};
+
+/// Rooms are stored in B by B blocks, blocks row by row, and rooms within a
+/// block in Z-order (Morton order). Rooms near each other in any direction are
+/// likely to share a cache line or page. The grid is padded to whole blocks.
+///
+/// \tparam B The block width and height. Must be a power of 2.
+template <size_t B = 8>
+struct tiled {
+    static_assert(B > 0 && (B & (B - 1)) == 0, "B is not a power of 2");
+    static_assert(B <= (1 << 16), "B is not <= 2^16");
+
+    static size_t size(const size_t rows, const size_t cols)
+    {
+        return blocks(rows) * blocks(cols) * B * B;
+    }
+
+    static size_t index(const size_t r, const size_t c, const size_t cols)
+    {
+        const size_t block = (r / B) * blocks(cols) + c / B;
+        return block * B * B + (spread(r % B) << 1) + spread(c % B);
+    }
+
+private:
+    static size_t blocks(const size_t n) { return (n + B - 1) / B; }
+
+    /// \return the bits of \c x, at most 16, interleaved with zeros.
+    static size_t spread(size_t x)
+    {
+        x = (x | (x << 8)) & 0x00ff00ff;
+        x = (x | (x << 4)) & 0x0f0f0f0f;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    }
+};
+
+/// An R(ows) by C(olumns) grid of rooms, stored on the heap in the specified
+/// layout and accessed as for a \c maze, i.e. \c g[r][c].
+///
+/// \tparam Layout The room storage layout, e.g. \c row_major or \c tiled.
+template <size_t R, size_t C, typename Layout = row_major>
+class grid {
+public:
+    /// A row of rooms.
+    template <typename Grid, typename Room>
+    class basic_row {
+    public:
+        basic_row(Grid& g, const size_t r) : g_(g), r_(r) {}
+
+        /// \return the room in column \c c.
+        Room& operator[](const size_t c) const
+        {
+            assert(r_ < R && c < C);
+            return g_.rooms_[Layout::index(r_, c, C)];
+        }
+
+    private:
+        Grid& g_;
+        const size_t r_;
+    };
+
+    using row = basic_row<grid, room>;
+    using const_row = basic_row<const grid, const room>;
+
+    grid() : rooms_(Layout::size(R, C)) {}
+
+    /// \return the row \c r.
+    row operator[](const size_t r) { return row(*this, r); }
+    const_row operator[](const size_t r) const { return const_row(*this, r); }
+
+private:
+    std::vector<room> rooms_;
+};
+
+/// \return the number of rows of rooms of a grid.
+template <size_t R, size_t C, typename Layout>
+size_t rows(const grid<R, C, Layout>&) { return R; }
+
+/// \return the number of columns of rooms of a grid.
+template <size_t R, size_t C, typename Layout>
+size_t cols(const grid<R, C, Layout>&) { return C; }
+
+} // namespace maze
@@ -0,0 +1,192 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Lowest common ancestor index for path queries between any two rooms.
+///
+/// See README for problem and solution description.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// An index answering distance and path queries between any two rooms of a
+/// perfect maze, i.e. a maze whose doors form a spanning tree of its rooms, as
+/// produced by \c generate.
+///
+/// The tree is rooted at a specified room and each room records its depth, its
+/// parent and a single skew-binary jump pointer. Ancestor and lowest common
+/// ancestor queries follow jump pointers, so run in O(log n) time, while the
+/// index takes O(n) space regardless of the maze's depth.
+///
+/// \note The distance between two rooms is their depths less twice the depth of
+/// their lowest common ancestor and the unique path between them runs through
+/// that ancestor.
+template <size_t R, size_t C>
+class lca_index {
+public:
+    using index_t = uint32_t;
+
+    static_assert(
+            R * C < std::numeric_limits<index_t>::max(),
+            "R * C is not < the index type's maximum");
+
+    /// Build the index.
+    ///
+    /// \pre \c m is a perfect maze.
+    /// \tparam Maze A \c maze, or any type whose rooms are accessed likewise.
+    /// \param m The maze to index.
+    /// \param root The co-ordinates of the room to root the tree at.
+    template <typename Maze>
+    explicit lca_index(const Maze& m, const coord& root = {0, 0});
+
+    /// \return the lowest common ancestor of rooms \c a and \c b.
+    coord lca(const coord& a, const coord& b) const;
+
+    /// \return the number of doors on the path between rooms \c a and \c b.
+    size_t distance(const coord& a, const coord& b) const;
+
+    /// \return the unique path from room \c a to room \c b.
+    path find_path(const coord& a, const coord& b) const;
+
+    /// \return the co-ordinates of the room the tree is rooted at.
+    coord root() const { return coordinate(root_); }
+
+private:
+    index_t ancestor(index_t i, index_t depth) const;
+    coord coordinate(index_t i) const { return {i / C, i % C}; }
+    index_t index(const coord& c) const { return c.row * C + c.col; }
+    index_t lca(index_t a, index_t b) const;
+
+    index_t root_;
+    std::vector<index_t> depth_;    /// Rooms from the root.
+    std::vector<index_t> parent_;   /// The root is its own parent.
+    std::vector<index_t> jump_;     /// Skew-binary ancestor.
+};
+
+template <size_t R, size_t C>
+template <typename Maze>
+lca_index<R, C>::lca_index(const Maze& m, const coord& root) :
+    root_(index(root)),
+    depth_(R * C, 0),
+    parent_(R * C, 0),
+    jump_(R * C, 0)
+{
+    assert(root.row < R && root.col < C);
+
+    // Explore breadth first from the root so that a room's ancestors are
+    // indexed before it. The maze is a tree so the only visited neighbour of a
+    // room is its parent.
+    std::vector<index_t> queue;
+    queue.reserve(R * C);
+    queue.push_back(root_);
+    parent_[root_] = root_;
+    jump_[root_] = root_;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const index_t i = queue[head];
+        const coord current = coordinate(i);
+        const auto& room = m[current.row][current.col];
+        for (auto direction : {up, right, down, left}) {
+            if (!room.has_door(direction))
+                continue;
+
+            const auto d = delta(direction);
+            const index_t n = index(
+                    {current.row + d.first, current.col + d.second});
+            if (n == parent_[i])
+                continue;
+
+            // Jump twice as far as the parent's jump if the parent's jump and
+            // its jump's jump span the same distance, else jump to the parent.
+            const index_t j = jump_[i];
+            parent_[n] = i;
+            depth_[n] = depth_[i] + 1;
+            jump_[n] = depth_[i] - depth_[j] == depth_[j] - depth_[jump_[j]] ?
+                    jump_[j] : i;
+            queue.push_back(n);
+        }
+    }
+    assert(queue.size() == R * C);
+}
+
+template <size_t R, size_t C>
+typename lca_index<R, C>::index_t
+lca_index<R, C>::ancestor(index_t i, const index_t depth) const
+{
+    assert(depth <= depth_[i]);
+
+    while (depth_[i] > depth)
+        i = depth_[jump_[i]] >= depth ? jump_[i] : parent_[i];
+    return i;
+}
+
+template <size_t R, size_t C>
+typename lca_index<R, C>::index_t
+lca_index<R, C>::lca(index_t a, index_t b) const
+{
+    // Lift the deeper room to the other's depth, then lift both until they
+    // meet, jumping whenever the jumps don't overshoot the common ancestor.
+    if (depth_[a] > depth_[b])
+        a = ancestor(a, depth_[b]);
+    else
+        b = ancestor(b, depth_[a]);
+    while (a != b) {
+        if (jump_[a] != jump_[b]) {
+            a = jump_[a];
+            b = jump_[b];
+        } else {
+            a = parent_[a];
+            b = parent_[b];
+        }
+    }
+    return a;
+}
+
+template <size_t R, size_t C>
+coord lca_index<R, C>::lca(const coord& a, const coord& b) const
+{
+    assert(a.row < R && a.col < C && b.row < R && b.col < C);
+    return coordinate(lca(index(a), index(b)));
+}
+
+template <size_t R, size_t C>
+size_t lca_index<R, C>::distance(const coord& a, const coord& b) const
+{
+    assert(a.row < R && a.col < C && b.row < R && b.col < C);
+
+    const index_t i = index(a);
+    const index_t j = index(b);
+    return depth_[i] + depth_[j] - 2 * depth_[lca(i, j)];
+}
+
+template <size_t R, size_t C>
+path lca_index<R, C>::find_path(const coord& a, const coord& b) const
+{
+    assert(a.row < R && a.col < C && b.row < R && b.col < C);
+
+    // Climb from a to the common ancestor, then append the climb from b to the
+    // common ancestor in reverse.
+    const index_t i = index(a);
+    const index_t j = index(b);
+    const index_t k = lca(i, j);
+
+    path p;
+    for (index_t n = i; n != k; n = parent_[n])
+        p.push_back(coordinate(n));
+    p.push_back(coordinate(k));
+    std::vector<index_t> descent;
+    descent.reserve(depth_[j] - depth_[k]);
+    for (index_t n = j; n != k; n = parent_[n])
+        descent.push_back(n);
+    for (auto n = descent.rbegin(); n != descent.rend(); ++n)
+        p.push_back(coordinate(*n));
+    return p;
+}
+
+} // namespace maze
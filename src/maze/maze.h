@@ -12,9 +12,16 @@
 #include <cassert>
 #include <cstdint>
 #include <deque>
-#include <iosfwd>
-#include <list>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <limits>
 #include <random>
+#include <string>
+#include <vector>
+
+#include <maze/random.h>
 
 namespace maze {
 
@@ -25,16 +32,55 @@ std::ostream& operator<<(std::ostream&, const coord&);
 /// Directions.
 enum direction: uint8_t { up = 1, right = 2, down = 4, left = 8 };
 
-std::array<direction, 4> get_shuffled_directions()
+/// \return the directions shuffled using a single number from the specified
+/// random \c generator, which selects one of the 24 permutations of the
+/// directions.
+template <typename Generator>
+std::array<direction, 4> get_shuffled_directions(Generator& generator)
 {
-    using namespace std;
-
-    static random_device device;
-    static mt19937_64 generator;
+    static_assert(
+            std::numeric_limits<typename Generator::result_type>::digits >= 64,
+            "Generator does not produce 64 bit numbers");
+
+    static const std::array<direction, 4> PERMUTATIONS[24] = {
+        {{ up, right, down, left }},
+        {{ up, right, left, down }},
+        {{ up, down, right, left }},
+        {{ up, down, left, right }},
+        {{ up, left, right, down }},
+        {{ up, left, down, right }},
+        {{ right, up, down, left }},
+        {{ right, up, left, down }},
+        {{ right, down, up, left }},
+        {{ right, down, left, up }},
+        {{ right, left, up, down }},
+        {{ right, left, down, up }},
+        {{ down, up, right, left }},
+        {{ down, up, left, right }},
+        {{ down, right, up, left }},
+        {{ down, right, left, up }},
+        {{ down, left, up, right }},
+        {{ down, left, right, up }},
+        {{ left, up, right, down }},
+        {{ left, up, down, right }},
+        {{ left, right, up, down }},
+        {{ left, right, down, up }},
+        {{ left, down, up, right }},
+        {{ left, down, right, up }},
+    };
+
+    // Scale the high 32 bits of the number to [0, 24) by multiplication,
+    // avoiding a division.
+    const uint64_t x = static_cast<uint64_t>(generator()) >> 32;
+    return PERMUTATIONS[(x * 24) >> 32];
+}
 
-    array<direction, 4> directions = {{ up, right, down, left }};
-    shuffle(begin(directions), end(directions), generator);
-    return directions;
+/// \return the directions shuffled using a generator local to the calling
+/// thread and seeded from \c std::random_device.
+std::array<direction, 4> get_shuffled_directions()
+{
+    thread_local xoshiro256 generator(std::random_device{}());
+    return get_shuffled_directions(generator);
 }
 
 /// Grid coordinates.
@@ -58,16 +104,6 @@ std::ostream& operator<<(std::ostream& o, const coord& c)
     return o << '(' << c.row << "," << c.col << ')';
 }
 
-/// Maze path.
-using path = std::list<coord>;
-
-std::ostream& operator<<(std::ostream& o, const path& p)
-{
-    for (const auto& coord : p)
-        std::cout << coord << ' ';
-    return std::cout << std::endl;
-}
-
 /// \return row and column deltas to move in the specified direction.
 std::pair<int, int> delta(direction d)
 {
@@ -88,7 +124,7 @@ std::string to_string(direction d)
         return "d";
     if (d == right)
         return "r";
-    assert(d = left);
+    assert(d == left);
     return "l";
 }
 
@@ -104,6 +140,162 @@ direction reverse(direction d)
     return right;
 }
 
+/// Maze path: its first room and the direction of each move to the next room,
+/// packed 2 bits per move into a contiguous buffer, so a path of n rooms takes
+/// about n / 4 bytes. Adding or removing a room at the end only allocates when
+/// the buffer grows. Iterating yields the rooms' co-ordinates in order.
+class path {
+public:
+    /// A forward iterator over the rooms of a path.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = coord;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const coord*;
+        using reference = const coord&;
+
+        const_iterator() : path_(nullptr), i_(0), coord_{0, 0} {}
+        const_iterator(const path* p, size_t i, const coord& c) :
+            path_(p), i_(i), coord_(c)
+        {}
+
+        const coord& operator*() const { return coord_; }
+        const coord* operator->() const { return &coord_; }
+
+        const_iterator& operator++()
+        {
+            if (++i_ < path_->size_)
+                coord_ = step(coord_, path_->move(i_ - 1));
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator i = *this;
+            ++*this;
+            return i;
+        }
+
+        bool operator==(const const_iterator& o) const { return i_ == o.i_; }
+        bool operator!=(const const_iterator& o) const { return i_ != o.i_; }
+
+    private:
+        const path* path_;
+        size_t i_;                      /// The room's index.
+        coord coord_;                   /// The room's co-ordinates.
+    };
+    using iterator = const_iterator;
+
+    path() : size_(0), front_{0, 0}, back_{0, 0} {}
+    path(std::initializer_list<coord> rooms) : path()
+    {
+        for (const auto& room : rooms)
+            push_back(room);
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }           /// The number of rooms.
+    const coord& front() const { assert(!empty()); return front_; }
+    const coord& back() const { assert(!empty()); return back_; }
+
+    /// \pre \c i + 1 < \c size().
+    /// \return the direction of the move from room \c i to the next.
+    direction move(size_t i) const
+    {
+        const uint64_t code = moves_[i / 32] >> (2 * (i % 32)) & 3;
+        return static_cast<direction>(1 << code);
+    }
+
+    /// Add a room to the end.
+    ///
+    /// \pre The path is empty or \c c is a neighbour of \c back().
+    void push_back(const coord& c);
+
+    /// Add the room in direction \c d from \c back() to the end.
+    void push_back(direction d);
+
+    /// Remove the last room.
+    void pop_back();
+
+    void clear() { moves_.clear(); size_ = 0; }
+    void reserve(size_t rooms) { moves_.reserve(rooms / 32 + 1); }
+
+    const_iterator begin() const { return {this, 0, front_}; }
+    const_iterator end() const { return {this, size_, back_}; }
+
+    bool operator==(const path& o) const
+    {
+        return size_ == o.size_ &&
+            (size_ == 0 || (front_ == o.front_ && moves_ == o.moves_));
+    }
+    bool operator!=(const path& o) const { return !(*this == o); }
+
+private:
+    static coord step(const coord& c, direction d)
+    {
+        const auto delta = ::maze::delta(d);
+        return {c.row + delta.first, c.col + delta.second};
+    }
+
+    std::vector<uint64_t> moves_;       /// 32 moves per word, low bits first.
+    size_t size_;
+    coord front_;
+    coord back_;
+};
+
+void path::push_back(const coord& c)
+{
+    if (empty()) {
+        front_ = back_ = c;
+        size_ = 1;
+        return;
+    }
+
+    if (c.row + 1 == back_.row && c.col == back_.col)
+        push_back(up);
+    else if (c.row == back_.row + 1 && c.col == back_.col)
+        push_back(down);
+    else if (c.row == back_.row && c.col == back_.col + 1)
+        push_back(right);
+    else {
+        assert(c.row == back_.row && c.col + 1 == back_.col);
+        push_back(left);
+    }
+}
+
+void path::push_back(const direction d)
+{
+    assert(!empty());
+
+    const size_t i = size_ - 1;
+    if (i % 32 == 0)
+        moves_.push_back(0);
+    moves_[i / 32] |= uint64_t(__builtin_ctz(d)) << (2 * (i % 32));
+    back_ = step(back_, d);
+    ++size_;
+}
+
+void path::pop_back()
+{
+    assert(!empty());
+
+    if (--size_ == 0)
+        return;
+    const size_t i = size_ - 1;
+    back_ = step(back_, reverse(move(i)));
+    moves_[i / 32] &= ~(uint64_t(3) << (2 * (i % 32)));
+    if (i % 32 == 0)
+        moves_.pop_back();
+}
+
+std::ostream& operator<<(std::ostream& o, const path& p)
+{
+    for (const auto& coord : p)
+        o << coord << ' ';
+    return o << std::endl;
+}
+
 /// Maze room containing doors, exit and path data.
 class room {
 public:
@@ -113,7 +305,10 @@ public:
     ~room() = default;
 
     void add_door(direction d) { doors_ |= d; }
+    void remove_door(direction d) { doors_ &= ~d; }
     bool has_door(direction d) const { return doors_ & d; }
+    void doors(uint8_t doors) { doors_ = doors; }   /// Set all door bits.
+    uint8_t doors() const { return doors_; }        /// Door bits.
     void exit(bool exit) { exit_ = exit; }
     bool exit() const { return exit_; }
     void start(bool start) { start_ = start; }
@@ -122,15 +317,21 @@ public:
     bool path() const { return path_; }
 
 private:
-    unsigned int doors_:4;      /// Bitfield for room's doors.
-    unsigned int exit_:1;       /// The room is the exit.
-    unsigned int start_:1;      /// The room is the start of the path.
-    unsigned int path_:1;       /// The room is on the path.
+    uint8_t doors_:4;           /// Bitfield for room's doors.
+    uint8_t exit_:1;            /// The room is the exit.
+    uint8_t start_:1;           /// The room is the start of the path.
+    uint8_t path_:1;            /// The room is on the path.
 };
 
 /// A maze is an R(ows) by C(olumns) grid of rooms.
 template <size_t R, size_t C> using maze = std::array<std::array<room,C>, R>;
 
+/// \return the number of rows of rooms of a maze.
+template <size_t R, size_t C> size_t rows(const maze<R, C>&) { return R; }
+
+/// \return the number of columns of rooms of a maze.
+template <size_t R, size_t C> size_t cols(const maze<R, C>&) { return C; }
+
 // Forward declarations.
 template <size_t R, size_t C> void foreach_room(maze<R, C>&, const std::function<void (room&)>&);
 template <size_t R, size_t C> void clear_path(maze<R, C>&);
@@ -157,50 +358,52 @@ void clear_path(maze<R, C>& m)
             });
 }
 
+/// Print the maze, including the exit and any marked path.
+///
+/// Each row of rooms is formatted as two lines, its up walls and its rooms,
+/// into a buffer of several rows that is written with a single call.
 template <size_t R, size_t C>
 std::ostream& operator<<(std::ostream& os, const maze<R, C>& m)
 {
-    using namespace std;
+    constexpr size_t WIDTH = 2 * C + 2;             // Including the newline.
+    constexpr size_t BLOCK = (1 << 16) / (2 * WIDTH) + 1;
 
-    // For each row  ...
+    std::string buffer;
+    buffer.reserve(std::min(R, BLOCK) * 2 * WIDTH + WIDTH);
     for (size_t r = 0; r < R; ++r) {
-        // ... for each room ...
+        // Print up doors/walls ...
         for (size_t c = 0; c < C; ++c) {
-            // ... print up door/wall ...
-            os << "+";
-            os << (m[r][c].has_door(up) ? " " : "-");
-            if (c == C - 1)
-                os << "+";
+            buffer.push_back('+');
+            buffer.push_back(m[r][c].has_door(up) ? ' ' : '-');
         }
-        os << endl;
+        buffer.append("+\n");
 
-        // ... for each room ...
+        // ... then left doors/walls and rooms ...
         for (size_t c = 0; c < C; ++c) {
-            // ... print left door/wall ...
             const auto& room = m[r][c];
+            buffer.push_back(room.has_door(left) ? ' ' : '|');
+            if (room.exit())
+                buffer.push_back('X');
+            else if (room.start())
+                buffer.push_back('S');
+            else if (room.path())
+                buffer.push_back('*');
+            else
+                buffer.push_back(' ');
+        }
+        buffer.append("|\n");                       // ... and the right wall.
 
-            os << (room.has_door(left) ? " " : "|");
-
-            if (room.exit()) {
-                os << "X";
-            } else if (room.start()) {
-                os << "S";
-            } else if (room.path()) {
-                os << "*";
-            } else {
-                os <<  " ";
-            }
-
-            if (c == C - 1)
-                os << "|";      // ... print right wall.
+        if ((r + 1) % BLOCK == 0) {
+            os.write(buffer.data(), buffer.size());
+            buffer.clear();
         }
-        os << endl;
     }
 
     // Bottom wall.
     for (size_t c = 0; c < C; ++c)
-        os << "+-";
-    return os << "+" << endl;
+        buffer.append("+-");
+    buffer.append("+\n");
+    return os.write(buffer.data(), buffer.size());
 }
 
 /// Mark the path.
@@ -0,0 +1,71 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Fast, seedable random number generation for maze generation.
+///
+/// See README description.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace maze {
+
+/// \return a seed for the specified \c stream of a random sequence, mixed from
+/// \c seed by the SplitMix64 finalizer so that consecutive streams are
+/// uncorrelated.
+uint64_t mix_seed(const uint64_t seed, const uint64_t stream)
+{
+    uint64_t z = seed + (stream + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/// The xoshiro256** pseudo random number generator.
+///
+/// 32 bytes of state and a handful of shifts, rotates and multiplies per
+/// number, versus 2.5KB of state for \c std::mt19937_64. Satisfies the
+/// standard uniform random bit generator requirements, so may be used with
+/// \c std::shuffle and the standard distributions.
+class xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    /// Seed the generator's state from the SplitMix64 sequence of \c seed.
+    explicit xoshiro256(const uint64_t seed = 0)
+    {
+        for (uint64_t i = 0; i < 4; ++i)
+            s_[i] = mix_seed(seed, i);
+    }
+
+    constexpr static result_type min() { return 0; }
+    constexpr static result_type max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()()
+    {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotl(const uint64_t x, const int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t s_[4];
+};
+
+} // namespace maze
@@ -0,0 +1,254 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Export mazes as images.
+///
+/// See README description.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <maze/maze.h>
+
+namespace maze {
+
+/// The kinds of image pixel.
+///
+/// A maze of R by C rooms is drawn as a (2R + 1) by (2C + 1) pixel image: room
+/// (r, c) is pixel (2r + 1, 2c + 1) and the pixels between rooms are walls or
+/// doors. The pixels at even rows and columns are always walls.
+enum class pixel : uint8_t { wall, floor, path, start, exit };
+
+/// Draw row \c y of the image of a maze.
+///
+/// \param m The maze.
+/// \param y The image row, in [0, 2R + 1).
+/// \param out The row's 2C + 1 pixels.
+template <typename Maze>
+void draw_row(const Maze& m, const size_t y, pixel* const out)
+{
+    const size_t R = rows(m);
+    const size_t C = cols(m);
+    const size_t r = y / 2;
+
+    for (size_t x = 0; x < 2 * C + 1; x += 2)
+        out[x] = pixel::wall;
+
+    if (y % 2 == 0) {
+        // A line of up walls or doors between rooms r - 1 and r.
+        for (size_t c = 0; c < C; ++c) {
+            const bool above = r > 0 && m[r - 1][c].has_door(down);
+            const bool below = r < R && m[r][c].has_door(up);
+            const bool path = above && below &&
+                    m[r - 1][c].path() && m[r][c].path();
+            out[2 * c + 1] = path ? pixel::path :
+                    above || below ? pixel::floor : pixel::wall;
+        }
+        return;
+    }
+
+    // A line of rooms and the left walls or doors between them.
+    for (size_t c = 0; c < C; ++c) {
+        const auto& room = m[r][c];
+        if (room.exit())
+            out[2 * c + 1] = pixel::exit;
+        else if (room.start())
+            out[2 * c + 1] = pixel::start;
+        else if (room.path())
+            out[2 * c + 1] = pixel::path;
+        else
+            out[2 * c + 1] = pixel::floor;
+
+        const bool before = c > 0 && m[r][c - 1].has_door(right);
+        if (before || room.has_door(left)) {
+            const bool path = before && room.path() && m[r][c - 1].path();
+            out[2 * c] = path ? pixel::path : pixel::floor;
+        }
+    }
+}
+
+/// Write the image of a maze, a row at a time.
+///
+/// \param m The maze.
+/// \param write Called with each row of pixels.
+template <typename Maze, typename Write>
+void draw(const Maze& m, Write write)
+{
+    std::vector<pixel> row(2 * cols(m) + 1);
+    for (size_t y = 0; y < 2 * rows(m) + 1; ++y) {
+        draw_row(m, y, row.data());
+        write(row);
+    }
+}
+
+/// Write a maze as a binary portable bitmap (PBM) with a black pixel per wall.
+template <typename Maze>
+void write_pbm(std::ostream& os, const Maze& m)
+{
+    const size_t width = 2 * cols(m) + 1;
+    const size_t height = 2 * rows(m) + 1;
+    os << "P4\n" << width << ' ' << height << '\n';
+
+    std::string bits((width + 7) / 8, 0);
+    draw(m, [&] (const std::vector<pixel>& row) {
+        std::fill(begin(bits), end(bits), 0);
+        for (size_t x = 0; x < width; ++x)
+            if (row[x] == pixel::wall)
+                bits[x / 8] |= 0x80 >> (x % 8);
+        os.write(bits.data(), bits.size());
+    });
+}
+
+/// Write a maze as a binary portable graymap (PGM): black walls, white rooms
+/// and doors, with paths in gray and the start and exit in dark gray.
+template <typename Maze>
+void write_pgm(std::ostream& os, const Maze& m)
+{
+    static const char GRAYS[] = { 0, '\xff', '\xa0', '\x50', '\x50' };
+
+    const size_t width = 2 * cols(m) + 1;
+    const size_t height = 2 * rows(m) + 1;
+    os << "P5\n" << width << ' ' << height << "\n255\n";
+
+    std::string grays(width, 0);
+    draw(m, [&] (const std::vector<pixel>& row) {
+        for (size_t x = 0; x < width; ++x)
+            grays[x] = GRAYS[static_cast<size_t>(row[x])];
+        os.write(grays.data(), grays.size());
+    });
+}
+
+/// Portable network graphics (PNG) encoding helpers.
+namespace png {
+
+/// \return the CRC-32 of \c n bytes at \c data, continuing from \c crc.
+uint32_t crc32(const uint8_t* const data, const size_t n, uint32_t crc = 0)
+{
+    static const std::vector<uint32_t> TABLE = [] () {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i)
+        crc = TABLE[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+/// Append \c v to \c out big endian.
+void put32(std::string& out, const uint32_t v)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<char>(v >> shift));
+}
+
+/// Write a chunk of the specified \c type and \c data.
+void write_chunk(
+        std::ostream& os,
+        const char* const type,
+        const std::string& data)
+{
+    std::string chunk;
+    put32(chunk, static_cast<uint32_t>(data.size()));
+    chunk.append(type, 4);
+    chunk.append(data);
+    const auto bytes = reinterpret_cast<const uint8_t*>(chunk.data());
+    put32(chunk, crc32(bytes + 4, chunk.size() - 4));
+    os.write(chunk.data(), chunk.size());
+}
+
+} // namespace png
+
+/// Write a maze as a PNG image: black walls, white rooms and doors, with paths
+/// in red, the start in green and the exit in blue.
+///
+/// The image is paletted, a byte per pixel, and the image data isn't
+/// compressed (it's stored in deflate blocks of at most 64KB), trading size
+/// for speed and the lack of a dependency on a compression library.
+template <typename Maze>
+void write_png(std::ostream& os, const Maze& m)
+{
+    using namespace std;
+
+    const uint32_t width = 2 * cols(m) + 1;
+    const uint32_t height = 2 * rows(m) + 1;
+    os.write("\x89PNG\r\n\x1a\n", 8);
+
+    string header;
+    png::put32(header, width);
+    png::put32(header, height);
+    header.append("\x08\x03\x00\x00\x00", 5);   // 8 bit paletted, no interlace.
+    png::write_chunk(os, "IHDR", header);
+    png::write_chunk(
+            os,
+            "PLTE",
+            string("\x00\x00\x00" "\xff\xff\xff" "\xd0\x20\x20"
+                   "\x20\xb0\x20" "\x20\x40\xd0", 15));
+
+    // The zlib stream: a header, stored deflate blocks of filter-byte-prefixed
+    // rows and an Adler-32 checksum. Each block is written in an IDAT chunk as
+    // it fills.
+    constexpr size_t BLOCK = 65535;
+    const uint64_t total = static_cast<uint64_t>(width + 1) * height;
+    uint64_t written = 0;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    string data("\x78\x01", 2);
+    string block;
+    block.reserve(BLOCK);
+    auto flush = [&] () {
+        written += block.size();
+        const uint16_t n = static_cast<uint16_t>(block.size());
+        const uint16_t complement = ~n;
+        data.push_back(written == total ? 1 : 0);   // Final block?
+        data.push_back(static_cast<char>(n));
+        data.push_back(static_cast<char>(n >> 8));
+        data.push_back(static_cast<char>(complement));
+        data.push_back(static_cast<char>(complement >> 8));
+        data.append(block);
+        block.clear();
+        if (written == total)
+            png::put32(data, (b << 16) | a);
+        png::write_chunk(os, "IDAT", data);
+        data.clear();
+    };
+
+    string line(width + 1, 0);                      // No filter.
+    draw(m, [&] (const vector<pixel>& row) {
+        for (size_t x = 0; x < width; ++x)
+            line[x + 1] = static_cast<char>(row[x]);
+
+        // Sum in runs short enough not to overflow before the modulo.
+        for (size_t i = 0; i < line.size(); i += 5552) {
+            const size_t end = min(line.size(), i + 5552);
+            for (size_t j = i; j < end; ++j) {
+                a += static_cast<uint8_t>(line[j]);
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+
+        for (size_t i = 0; i < line.size();) {
+            const size_t n = min(line.size() - i, BLOCK - block.size());
+            block.append(line, i, n);
+            i += n;
+            if (block.size() == BLOCK || written + block.size() == total)
+                flush();
+        }
+    });
+    png::write_chunk(os, "IEND", "");
+}
+
+} // namespace maze
@@ -1,15 +1,38 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
+#include <unistd.h>
+
+#include <maze/analytics.h>
+#include <maze/batch.h>
+#include <maze/bitplane.h>
+#include <maze/dynamic.h>
+#include <maze/file.h>
 #include <maze/find-path.h>
 #include <maze/generate.h>
+#include <maze/generate-tiled.h>
+#include <maze/layout.h>
+#include <maze/lca.h>
 #include <maze/maze.h>
+#include <maze/render.h>
 
 using namespace std;
 using namespace maze;
 
+/// All directions, qualified as \c std also declares \c left and \c right.
+static const direction DIRECTIONS[] =
+        { ::maze::up, ::maze::right, ::maze::down, ::maze::left };
+
 /// Example generate and find and mark a path to the exit.
 template <size_t R, size_t C>
-maze<R, C> example(const size_t exit_row, const size_t exit_col)
+::maze::maze<R, C> example(const size_t exit_row, const size_t exit_col)
 {
     const coord start = {R - 1 - exit_row, C - 1 - exit_col};
     const coord exit = {exit_row, exit_col};
@@ -60,8 +83,509 @@ static void test()
     example<10, 10>(8, 1);
 }
 
+/// Check the LCA index's paths against DFS between all pairs of rooms.
+template <size_t R, size_t C>
+static void test_lca(const coord& exit)
+{
+    const auto maze = generate<R, C>(exit);
+    const lca_index<R, C> index(maze, exit);
+    assert(index.root() == exit);
+    for (size_t i = 0; i < R * C; ++i) {
+        for (size_t j = 0; j < R * C; ++j) {
+            const coord a = {i / C, i % C};
+            const coord b = {j / C, j % C};
+            const auto expected = find_path_iterative(maze, a, b);
+            assert(index.find_path(a, b) == expected);
+            assert(index.distance(a, b) == expected.size() - 1);
+        }
+    }
+}
+
+/// Check bit-parallel distances against DFS paths to the exit.
+template <size_t R, size_t C>
+static void test_bitplanes(const coord& exit)
+{
+    const auto maze = generate<R, C>(exit);
+    const bitplanes<R, C> planes(maze);
+    const auto distances = planes.distances(exit);
+    const auto reachable = planes.reachable(exit);
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t c = 0; c < C; ++c) {
+            const coord start = {r, c};
+            const auto expected = find_path_iterative(maze, start, exit);
+            assert(planes.distance(start, exit) == expected.size() - 1);
+            assert(distances[r * C + c] == expected.size() - 1);
+            assert((bitplanes<R, C>::test(
+                    &reachable[r * bitplanes<R, C>::WORDS], c)));
+        }
+    }
+
+    // Rooms walled off from each other are unreachable.
+    const ::maze::maze<R, C> walled;
+    const bitplanes<R, C> walled_planes(walled);
+    if (R * C > 1) {
+        const coord corner = {R - 1, C - 1};
+        assert(!walled_planes.reachable({0, 0}, corner));
+        assert((walled_planes.distance({0, 0}, corner) ==
+                bitplanes<R, C>::UNREACHABLE));
+    }
+}
+
+/// \return true iff the maze's doors form a spanning tree of its rooms.
+template <size_t R, size_t C>
+static bool is_perfect(const ::maze::maze<R, C>& maze)
+{
+    size_t doors = 0;
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t c = 0; c < C; ++c) {
+            for (auto direction : DIRECTIONS) {
+                if (!maze[r][c].has_door(direction))
+                    continue;
+                const auto d = delta(direction);
+                const size_t nr = r + d.first;
+                const size_t nc = c + d.second;
+                if (!(nr < R && nc < C) ||
+                        !maze[nr][nc].has_door(reverse(direction)))
+                    return false;
+                ++doors;
+            }
+        }
+    }
+
+    const auto reachable = bitplanes<R, C>(maze).reachable({0, 0});
+    for (size_t r = 0; r < R; ++r)
+        for (size_t c = 0; c < C; ++c)
+            if (!bitplanes<R, C>::test(
+                    &reachable[r * bitplanes<R, C>::WORDS], c))
+                return false;
+    return doors == 2 * (R * C - 1);
+}
+
+/// \return true iff mazes \c a and \c b have the same doors.
+template <size_t R, size_t C>
+static bool same_doors(const ::maze::maze<R, C>& a, const ::maze::maze<R, C>& b)
+{
+    for (size_t r = 0; r < R; ++r)
+        for (size_t c = 0; c < C; ++c)
+            for (auto direction : DIRECTIONS)
+                if (a[r][c].has_door(direction) != b[r][c].has_door(direction))
+                    return false;
+    return true;
+}
+
+/// Check tiled generation produces a perfect maze independent of threads.
+template <size_t R, size_t C>
+static void test_generate_tiled(const coord& exit, const size_t tile)
+{
+    auto single = std::make_unique<::maze::maze<R, C>>();
+    auto multi = std::make_unique<::maze::maze<R, C>>();
+    generate_tiled(*single, exit, 42, 1, tile);
+    generate_tiled(*multi, exit, 42, 4, tile);
+    assert(is_perfect(*single));
+    assert((*single)[exit.row][exit.col].exit());
+    assert(same_doors(*single, *multi));
+}
+
+/// Check seeded generation is reproducible with either generator.
+static void test_seed()
+{
+    const coord exit = {3, 5};
+    assert(same_doors(generate<10, 10>(exit, 7), generate<10, 10>(exit, 7)));
+    assert(!same_doors(generate<10, 10>(exit, 7), generate<10, 10>(exit, 8)));
+    assert(is_perfect(generate<10, 10, std::mt19937_64>(exit, 7)));
+
+    ::maze::maze<20, 20> a;
+    ::maze::maze<20, 20> b;
+    generate_tiled<std::mt19937_64>(a, exit, 7, 1, 8);
+    generate_tiled<std::mt19937_64>(b, exit, 7, 3, 8);
+    assert(is_perfect(a));
+    assert(same_doors(a, b));
+}
+
+/// Check mazes round trip through files and can be solved when mapped.
+template <size_t R, size_t C>
+static void test_file(const coord& exit)
+{
+    char filename[] = "/tmp/maze-test-XXXXXX";
+    close(mkstemp(filename));
+
+    const auto maze = generate<R, C>(exit, 11);
+    save(maze, filename);
+    ::maze::maze<R, C> loaded;
+    load(filename, loaded);
+    assert(same_doors(maze, loaded));
+    assert(loaded[exit.row][exit.col].exit());
+
+    const mapped_maze mapped(filename);
+    assert(mapped.rows() == R && mapped.cols() == C);
+    assert(mapped.exit() == exit);
+    const coord start = {R - 1 - exit.row, C - 1 - exit.col};
+    assert(find_path(mapped, start, exit) == find_path(maze, start, exit));
+    assert(find_path_recursive(mapped, start, exit) ==
+            find_path(maze, start, exit));
+
+    // Mismatched dimensions and foreign files are rejected.
+    bool thrown = false;
+    try {
+        ::maze::maze<R + 1, C> wrong;
+        load(filename, wrong);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        const mapped_maze foreign("/proc/self/exe");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Doors leading off the grid are rejected, rather than followed out of
+    // bounds.
+    const std::pair<coord, ::maze::direction> off[] = {
+        {{0, C - 1}, ::maze::up}, {{R - 1, C - 1}, ::maze::right},
+        {{R - 1, 0}, ::maze::down}, {{0, 0}, ::maze::left}};
+    for (const auto& o : off) {
+        save(maze, filename);
+        {
+            const size_t i = o.first.row * C + o.first.col;
+            std::fstream fs(filename,
+                    std::ios::binary | std::ios::in | std::ios::out);
+            fs.seekg(file_header::SIZE + i / 2);
+            const char byte = static_cast<char>(fs.get() |
+                    o.second << (4 * (i % 2)));
+            fs.seekp(file_header::SIZE + i / 2);
+            fs.put(byte);
+        }
+        thrown = false;
+        try {
+            load(filename, loaded);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try {
+            const mapped_maze corrupt(filename);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // Dimensions whose room count overflows are rejected, rather than mapped
+    // as a maze without door bits.
+    file_header h = {file_header::VERSION, 3, 0x5555555555555555, {0, 0}};
+    uint8_t header[file_header::SIZE];
+    h.encode(header);
+    thrown = false;
+    try {
+        file_header::decode(header);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    {
+        std::ofstream os(filename, std::ios::binary | std::ios::trunc);
+        os.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+    thrown = false;
+    try {
+        const mapped_maze overflow(filename);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    unlink(filename);
+}
+
+/// Check image walls match the printed maze and paths are highlighted.
+template <size_t R, size_t C>
+static void test_render(const coord& exit)
+{
+    auto maze = generate<R, C>(exit, 5);
+    const coord start = {R - 1 - exit.row, C - 1 - exit.col};
+    mark_path(maze, find_path(maze, start, exit));
+
+    std::ostringstream text;
+    text << maze;
+    std::istringstream lines(text.str());
+    std::vector<pixel> row(2 * C + 1);
+    for (size_t y = 0; y < 2 * R + 1; ++y) {
+        std::string line;
+        std::getline(lines, line);
+        assert(line.size() == 2 * C + 1);
+        draw_row(maze, y, row.data());
+        for (size_t x = 0; x < 2 * C + 1; ++x) {
+            const bool wall = line[x] == '+' || line[x] == '-' ||
+                    line[x] == '|';
+            assert(wall == (row[x] == pixel::wall));
+            if (line[x] == '*')
+                assert(row[x] == pixel::path);
+        }
+    }
+
+    std::ostringstream pbm;
+    write_pbm(pbm, maze);
+    std::ostringstream header;
+    header << "P4\n" << 2 * C + 1 << ' ' << 2 * R + 1 << '\n';
+    assert(pbm.str().size() ==
+            header.str().size() + (2 * R + 1) * ((2 * C + 1 + 7) / 8));
+}
+
+/// Check mazes generated in grids of any layout have the same doors.
+template <size_t R, size_t C>
+static void test_layout(const coord& exit)
+{
+    auto maze = std::make_unique<::maze::maze<R, C>>();
+    grid<R, C, row_major> rows;
+    grid<R, C, tiled<8>> tiles;
+    generate_tiled(*maze, exit, 3, 2, 16);
+    generate_tiled(rows, exit, 3, 2, 16);
+    generate_tiled(tiles, exit, 3, 2, 16);
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t c = 0; c < C; ++c) {
+            assert((*maze)[r][c].doors() == rows[r][c].doors());
+            assert((*maze)[r][c].doors() == tiles[r][c].doors());
+        }
+    }
+
+    const coord start = {R - 1 - exit.row, C - 1 - exit.col};
+    const auto expected = find_path(*maze, start, exit);
+    assert(find_path(tiles, start, exit) == expected);
+    assert((lca_index<R, C>(tiles, exit).find_path(start, exit) == expected));
+}
+
+/// Check incrementally maintained distances and paths against a full search
+/// after each of a sequence of random door edits.
+template <size_t R, size_t C>
+static void test_dynamic(const coord& exit, const size_t edits)
+{
+    auto maze = generate<R, C>(exit, 17);
+    dynamic_maze<R, C> dynamic(maze, exit);
+    xoshiro256 generator(17);
+    for (size_t k = 0; k < edits; ++k) {
+        const coord c = {generator() % R, generator() % C};
+        const auto direction = DIRECTIONS[generator() % 4];
+        const auto d = delta(direction);
+        if (!(c.row + d.first < R && c.col + d.second < C))
+            continue;
+        if (maze[c.row][c.col].has_door(direction))
+            dynamic.close_door(c, direction);
+        else
+            dynamic.open_door(c, direction);
+
+        const auto distances = bitplanes<R, C>(maze).distances(exit);
+        for (size_t r = 0; r < R; ++r) {
+            for (size_t c = 0; c < C; ++c) {
+                const coord start = {r, c};
+                assert(dynamic.distance(start) == distances[r * C + c]);
+                const auto path = dynamic.find_path(start);
+                if (distances[r * C + c] == dynamic_maze<R, C>::UNREACHABLE) {
+                    assert(path.empty());
+                    continue;
+                }
+                assert(path.size() == distances[r * C + c] + 1);
+                assert(path.front() == start && path.back() == exit);
+            }
+        }
+    }
+}
+
+/// Check batches of queries, with few and many exits, against DFS.
+template <size_t R, size_t C>
+static void test_batch(common::thread_pool& pool)
+{
+    const auto maze = generate<R, C>({0, 0}, 23);
+    batch_solver solver(pool);
+    xoshiro256 generator(23);
+    for (size_t exits : {1, 3, 50}) {
+        std::vector<query> queries;
+        for (size_t k = 0; k < 200; ++k) {
+            const coord start = {generator() % R, generator() % C};
+            const size_t e = generator() % exits;
+            queries.push_back({start, {e % R, (e / R) % C}});
+        }
+        const auto paths = solver.solve(maze, queries);
+        assert(paths.size() == queries.size());
+        for (size_t k = 0; k < queries.size(); ++k)
+            assert(paths[k] == find_path(
+                    maze, queries[k].start, queries[k].exit));
+    }
+
+    // Rooms walled off from the exit have no path.
+    if (R * C > 1) {
+        const ::maze::maze<R, C> walled;
+        const auto paths = solver.solve(
+                walled,
+                {{{0, 0}, {0, 0}}, {{R - 1, C - 1}, {0, 0}}});
+        assert(paths[0].size() == 1 && paths[1].empty());
+    }
+}
+
+/// Check statistics against door counts and all pairs' LCA distances.
+template <size_t R, size_t C>
+static void test_analytics(const coord& exit)
+{
+    const auto maze = generate<R, C>(exit, 29);
+    const auto s = analyze(maze);
+    const lca_index<R, C> index(maze);
+
+    std::array<size_t, 5> doors = {};
+    size_t diameter = 0;
+    for (size_t r = 0; r < R; ++r) {
+        for (size_t c = 0; c < C; ++c) {
+            size_t n = 0;
+            for (auto direction : DIRECTIONS)
+                n += maze[r][c].has_door(direction);
+            ++doors[n];
+            for (size_t r2 = 0; r2 < R; ++r2)
+                for (size_t c2 = 0; c2 < C; ++c2)
+                    diameter = std::max(
+                            diameter,
+                            index.distance({r, c}, {r2, c2}));
+        }
+    }
+    assert(s.rooms == R * C);
+    assert(s.doors == doors);
+    assert(s.dead_ends == doors[1]);
+    assert(s.diameter == diameter);
+    assert(index.distance(s.from, s.to) == diameter);
+
+    const auto path = longest_path(maze);
+    assert(path.size() == diameter + 1);
+    assert(path == index.find_path(path.front(), path.back()));
+
+    // Cycles are detected.
+    if (R > 1 && C > 1) {
+        auto cyclic = maze;
+        for (size_t r = 0; r + 1 < R; ++r) {
+            for (size_t c = 0; c + 1 < C; ++c) {
+                cyclic[r][c].add_door(::maze::right);
+                cyclic[r][c + 1].add_door(::maze::left);
+                cyclic[r][c].add_door(::maze::down);
+                cyclic[r + 1][c].add_door(::maze::up);
+            }
+        }
+        bool thrown = false;
+        try {
+            analyze(cyclic);
+        } catch (const std::logic_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+}
+
+/// Check both searches expand each room at most once, and more than the rooms
+/// on the path before the exit.
+template <size_t R, size_t C>
+static void test_stats(const coord& exit)
+{
+    const auto maze = generate<R, C>(exit);
+    const coord start = {R - 1 - exit.row, C - 1 - exit.col};
+
+    search_stats<common::stats::enabled> iterative;
+    search_stats<common::stats::enabled> recursive;
+    const auto path = find_path_iterative(maze, start, exit, iterative);
+    assert(path == find_path_recursive(maze, start, exit, recursive));
+    for (const auto& s : {iterative, recursive}) {
+        assert(s.expanded.value() >= path.size() - 1);
+        assert(s.expanded.value() < R * C);
+    }
+
+    search_stats<> disabled;
+    assert(path == find_path_iterative(maze, start, exit, disabled));
+    assert(disabled.expanded.value() == 0);
+}
+
+/// Check a path against the co-ordinates pushed, across several words of moves.
+static void test_path()
+{
+    path p;
+    assert(p.empty() && p.begin() == p.end());
+    assert((p == path{}));
+
+    std::vector<coord> rooms = {{50, 50}};
+    p.push_back(rooms.back());
+    for (size_t i = 0; i < 100; ++i) {
+        const auto d = delta(DIRECTIONS[(i * 7 + i / 3) % 4]);
+        const coord& c = rooms.back();
+        rooms.push_back({c.row + d.first, c.col + d.second});
+        p.push_back(rooms.back());
+    }
+
+    while (!p.empty()) {
+        assert(p.size() == rooms.size());
+        assert(p.front() == rooms.front() && p.back() == rooms.back());
+        assert(std::equal(p.begin(), p.end(), rooms.begin(), rooms.end(),
+                    [] (const coord& a, const coord& b) { return a == b; }));
+        path q;
+        for (const auto& c : rooms)
+            q.push_back(c);
+        assert(p == q);
+        q.pop_back();
+        assert(p != q);
+
+        p.pop_back();
+        rooms.pop_back();
+    }
+    assert((path{{1, 1}, {1, 2}, {0, 2}}.move(1) == ::maze::up));
+}
+
 int main(int argc, char** argv)
 {
+    test_path();
     test();
+
+    test_lca<1, 1>({0, 0});
+    test_lca<3, 4>({1, 2});
+    test_lca<10, 10>({0, 0});
+    test_lca<10, 10>({4, 7});
+    test_lca<1, 40>({0, 20});
+
+    test_bitplanes<1, 1>({0, 0});
+    test_bitplanes<10, 10>({3, 5});
+    test_bitplanes<3, 130>({1, 64});
+    test_bitplanes<70, 2>({35, 1});
+
+    test_generate_tiled<1, 1>({0, 0}, 8);
+    test_generate_tiled<10, 10>({3, 5}, 10);
+    test_generate_tiled<50, 70>({49, 0}, 16);
+    test_generate_tiled<33, 129>({10, 100}, 7);
+    test_generate_tiled<500, 500>({250, 250}, 64);
+
+    test_seed();
+
+    test_file<1, 1>({0, 0});
+    test_file<3, 5>({1, 2});
+    test_file<10, 10>({0, 9});
+
+    test_render<1, 1>({0, 0});
+    test_render<10, 10>({2, 7});
+    test_render<4, 13>({3, 0});
+
+    test_layout<1, 1>({0, 0});
+    test_layout<37, 45>({36, 0});
+    test_layout<64, 64>({10, 20});
+
+    test_dynamic<1, 2>({0, 0}, 10);
+    test_dynamic<8, 8>({0, 0}, 400);
+    test_dynamic<15, 20>({7, 3}, 400);
+
+    common::thread_pool pool(3);
+    test_batch<1, 1>(pool);
+    test_batch<20, 30>(pool);
+    test_batch<20, 30>(pool);
+
+    test_analytics<1, 1>({0, 0});
+    test_analytics<1, 30>({0, 10});
+    test_analytics<12, 17>({5, 5});
+
+    test_stats<1, 1>({0, 0});
+    test_stats<10, 10>({0, 0});
+    test_stats<30, 20>({15, 3});
     return 0;
 }
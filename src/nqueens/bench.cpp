@@ -0,0 +1,64 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Benchmark the N queens solvers.
+
+#include <string>
+
+#include <common/bench.h>
+#include <common/thread-pool.h>
+#include <nqueens/dynamic-board.h>
+#include <nqueens/min-conflicts.h>
+#include <nqueens/nqueens.h>
+#include <nqueens/parallel.h>
+#include <nqueens/unique.h>
+
+using namespace std;
+using namespace nqueens;
+using common::bench::harness;
+using common::bench::keep;
+
+/// Benchmark finding a first solution and counting all solutions.
+template <size_t N>
+static void run(harness& h)
+{
+    const string size = to_string(N);
+    h.run("solve/" + size, N, [] () { keep(board<N>::solve()); });
+    h.run("solve_stats/" + size, N, [] () {
+        solve_stats<common::stats::enabled> stats;
+        keep(board<N>::solve(stats));
+        keep(stats.backtracks.value());
+    });
+    if (N > 13)
+        return;
+    h.run("count_all/" + size, N, [] () { keep(board<N>::count_all()); });
+    h.run("count_unique/" + size, N, [] () { keep(count_unique<N>()); });
+}
+
+int main(int argc, char** argv)
+{
+    harness h(argc, argv);
+    run<8>(h);
+    run<10>(h);
+    run<12>(h);
+    run<13>(h);
+    run<20>(h);
+    run<28>(h);
+
+    common::thread_pool pool;
+    h.run("count_all_parallel/13", 13, [&] () {
+        keep(count_all_parallel<13>(pool));
+    });
+
+    for (size_t n : {100, 1000}) {
+        h.run("dynamic_board/" + to_string(n), n, [n] () {
+            keep(dynamic_board::solve(n));
+        });
+    }
+    for (size_t n : {1000, 100000, 1000000}) {
+        h.run("min_conflicts/" + to_string(n), n, [n] () {
+            keep(min_conflicts(n));
+        });
+    }
+    return h.finish();
+}
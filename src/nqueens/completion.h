@@ -0,0 +1,135 @@
+#include <cstdint>
+
+#include <nqueens/nqueens.h>
+
+#pragma once
+
+namespace nqueens {
+
+/// The column of a row without a queen in a partial placement.
+constexpr uint8_t NO_QUEEN = 0xff;
+
+namespace detail {
+
+/// Completes a partial placement by backtracking, most constrained row first.
+///
+/// The columns, and diagonals of each direction, occupied are kept as masks of
+/// N and 2N - 1 bits. A row's domain, its free columns, is then the complement
+/// of the column mask and of windows of the diagonal masks. Before each
+/// choice the open rows' domains are checked: a row without free columns, or a
+/// free column in no row's domain, fails at once, and otherwise the row with
+/// the smallest domain is placed next.
+template <size_t N>
+class completion_solver {
+public:
+    explicit completion_solver(placement<N>& p) :
+        p_(p),
+        cols_(0),
+        diagonals_(0),
+        antidiagonals_(0),
+        open_(board<N>::ALL)
+    {}
+
+    /// Place the fixed queens.
+    ///
+    /// @return false iff a fixed queen can take another.
+    bool fix();
+
+    bool solve();
+
+private:
+    /// @return the free columns of row r.
+    RowType domain(size_t r) const
+    {
+        return board<N>::ALL &
+            ~(cols_ | diagonals_ >> r | antidiagonals_ >> (N - 1 - r));
+    }
+
+    void place(size_t r, RowType queen)
+    {
+        cols_ ^= queen;
+        diagonals_ ^= queen << r;
+        antidiagonals_ ^= queen << (N - 1 - r);
+        open_ ^= RowType(1) << r;
+    }
+
+    placement<N>& p_;
+    RowType cols_;
+    RowType diagonals_;             /// Bit r + c.
+    RowType antidiagonals_;         /// Bit c + N - 1 - r.
+    RowType open_;                  /// Rows without queens.
+};
+
+template <size_t N>
+bool completion_solver<N>::fix()
+{
+    for (size_t r = 0; r < N; ++r) {
+        if (p_[r] == NO_QUEEN)
+            continue;
+        assert(p_[r] < N);
+        const RowType queen = RowType(1) << p_[r];
+        if (!(domain(r) & queen))
+            return false;
+        place(r, queen);
+    }
+    return true;
+}
+
+template <size_t N>
+bool completion_solver<N>::solve()
+{
+    if (open_ == 0)
+        return true;
+
+    // Find the most constrained row, failing if a row has no free columns or
+    // a free column has no row.
+    size_t row = N;
+    size_t size = N + 1;
+    RowType covered = 0;
+    for (RowType rows = open_; rows; rows &= rows - 1) {
+        const size_t r = __builtin_ctzll(rows);
+        const RowType d = domain(r);
+        const size_t n = __builtin_popcountll(d);
+        if (n == 0)
+            return false;
+        if (n < size) {
+            row = r;
+            size = n;
+        }
+        covered |= d;
+    }
+    if (covered != (board<N>::ALL & ~cols_))
+        return false;
+
+    for (RowType free = domain(row); free; free &= free - 1) {
+        const RowType queen = free & -free;
+        place(row, queen);
+        if (solve()) {
+            p_[row] = __builtin_ctzll(queen);
+            return true;
+        }
+        place(row, queen);          // Backtrack: placing again removes it.
+    }
+    return false;
+}
+
+} // end namespace detail
+
+/// Complete a placement of queens on some rows to a solution to the N queens
+/// problem, if possible.
+///
+/// @param p The column of each row's queen, or NO_QUEEN for rows to be
+///          completed. Set to the solution, iff there's one.
+/// @return true iff the placement was completed.
+template <size_t N>
+bool complete(placement<N>& p)
+{
+    placement<N> q = p;
+    detail::completion_solver<N> solver(q);
+    if (!solver.fix() || !solver.solve())
+        return false;
+    p = q;
+    return true;
+}
+
+} // end namespace nqueens
@@ -0,0 +1,135 @@
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include <nqueens/nqueens.h>
+
+#pragma once
+
+namespace nqueens {
+
+namespace detail {
+
+/// An array usable in constant expressions, as std::array's non-const
+/// accessors aren't constexpr until C++17.
+template <typename T, size_t N>
+struct constexpr_array {
+    constexpr T& operator[](size_t i) { return data[i]; }
+    constexpr const T& operator[](size_t i) const { return data[i]; }
+
+    T data[N];
+};
+
+/// The state of a search for the solutions to the N queens problem, kept
+/// explicitly per row as for solution_stream, so that the search runs in
+/// constant expressions as well as at runtime.
+template <size_t N>
+struct search_state {
+    static_assert(N > 0, "N is not > 0");
+
+    constexpr search_state() :
+        cols(), left(), right(), free(), columns(), row(0), done(false)
+    {
+        free[0] = board<N>::ALL;
+    }
+
+    constexpr_array<RowType, N> cols;
+    constexpr_array<RowType, N> left;
+    constexpr_array<RowType, N> right;
+    constexpr_array<RowType, N> free;   /// Free columns not yet tried.
+    constexpr_array<uint8_t, N> columns;
+    size_t row;                         /// N after a solution.
+    bool done;
+};
+
+/// Advance the search to the next solution.
+///
+/// @return false iff there are no more solutions.
+template <size_t N>
+constexpr bool next(search_state<N>& s)
+{
+    if (s.done)
+        return false;
+    if (s.row == N)
+        --s.row;
+
+    while (true) {
+        if (s.free[s.row] == 0) {
+            if (s.row == 0) {
+                s.done = true;
+                return false;
+            }
+            --s.row;
+            continue;
+        }
+
+        const RowType queen = s.free[s.row] & -s.free[s.row];
+        s.free[s.row] ^= queen;
+        s.columns[s.row] = __builtin_ctzll(queen);
+        if (s.row == N - 1) {
+            s.row = N;
+            return true;
+        }
+
+        const size_t r = s.row++;
+        s.cols[s.row] = s.cols[r] | queen;
+        s.left[s.row] = (s.left[r] | queen) >> 1;
+        s.right[s.row] = (s.right[r] | queen) << 1;
+        s.free[s.row] =
+            board<N>::ALL & ~(s.cols[s.row] | s.left[s.row] | s.right[s.row]);
+    }
+}
+
+template <size_t N, size_t... I>
+constexpr placement<N> to_placement(
+        const constexpr_array<uint8_t, N>& columns,
+        std::index_sequence<I...>)
+{
+    return {{columns[I]...}};
+}
+
+} // end namespace detail
+
+/// Find the solution to the N queens problem board<N>::solve() finds, in a
+/// constant expression or at runtime.
+///
+/// @return the column of each row's queen.
+template <size_t N>
+constexpr placement<N> constexpr_solve()
+{
+    detail::search_state<N> s;
+    const bool result = detail::next(s);
+    return result ?
+        detail::to_placement(s.columns, std::make_index_sequence<N>()) :
+        throw std::domain_error("no N queens solution");
+}
+
+/// @return the number of solutions to the N queens problem, found in a
+///         constant expression or at runtime.
+template <size_t N>
+constexpr uint64_t constexpr_count()
+{
+    detail::search_state<N> s;
+    uint64_t n = 0;
+    while (detail::next(s))
+        ++n;
+    return n;
+}
+
+/// @return the number of solutions for N = 1 to sizeof...(N).
+template <size_t... N>
+constexpr std::array<uint64_t, sizeof...(N)> constexpr_counts(
+        std::index_sequence<N...>)
+{
+    return {{constexpr_count<N + 1>()...}};
+}
+
+/// The 8 queens solution found at compile time.
+constexpr placement<8> EIGHT_QUEENS = constexpr_solve<8>();
+
+/// The number of solutions for N = 1 to 8, counted at compile time.
+constexpr std::array<uint64_t, 8> SOLUTION_COUNTS =
+    constexpr_counts(std::make_index_sequence<8>());
+
+} // end namespace nqueens
@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <nqueens/nqueens.h>
+
+#pragma once
+
+namespace nqueens {
+
+/// A multi-word bitset of a fixed number of bits.
+class bitset {
+public:
+    explicit bitset(size_t n = 0) : words_(n / 64 + 2, 0) {}
+
+    bool test(size_t i) const { return words_[i / 64] >> (i % 64) & 1; }
+    void set(size_t i) { words_[i / 64] |= uint64_t(1) << (i % 64); }
+    void reset(size_t i) { words_[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+    /// @return bits [i, i + 64), where bits past the end are 0.
+    uint64_t window(size_t i) const
+    {
+        const size_t w = i / 64;
+        const size_t s = i % 64;
+        return s == 0 ?
+            words_[w] : (words_[w] >> s) | (words_[w + 1] << (64 - s));
+    }
+
+private:
+    std::vector<uint64_t> words_;   /// Padded so that windows may overrun.
+};
+
+/// A board of a runtime number of rows and columns for the N queens problem,
+/// for N beyond the 32 queens a \c board can hold.
+///
+/// A queen may be placed on each row. The columns and the diagonals of each
+/// direction occupied are kept as multi-word bitsets, so a square is checked in
+/// constant time and the free columns of a row are found 64 at a time.
+class dynamic_board {
+public:
+    constexpr static const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    /// @param n The width and height of the board, without queens.
+    explicit dynamic_board(size_t n);
+
+    /// @return a board configured with a solution to the N queens problem.
+    /// @exception std::domain_error if there's no solution, i.e. for n 2 or 3.
+    static dynamic_board solve(size_t n);
+
+    /// @return the width and height of the board.
+    size_t size() const { return queens_.size(); }
+
+    /// @return the column of each row's queen, or NONE.
+    const std::vector<uint32_t>& columns() const { return queens_; }
+
+    /// @return true iff the specified square is occupied.
+    bool get(size_t r, size_t c) const { return queens_[r] == c; }
+
+    /// @return true iff a queen on the specified square can't take another.
+    bool free(size_t r, size_t c) const
+    {
+        return !cols_.test(c) && !diagonals_.test(r + c) &&
+            !antidiagonals_.test(c + size() - 1 - r);
+    }
+
+    /// @return the free columns [c, c + 64) of row r, as a bitmap with column
+    ///         c the least significant bit.
+    uint64_t free_columns(size_t r, size_t c) const;
+
+    /// Place a queen.
+    ///
+    /// @pre Row r has no queen and the square is free.
+    void set(size_t r, size_t c);
+
+    /// Remove row r's queen.
+    void clear(size_t r);
+
+    /// @return true iff every row has a queen and no queen can take another.
+    bool valid() const;
+
+private:
+    std::vector<uint32_t> queens_;
+    bitset cols_;
+    bitset diagonals_;              /// Bit r + c.
+    bitset antidiagonals_;          /// Bit c + N - 1 - r.
+};
+
+dynamic_board::dynamic_board(const size_t n) :
+    queens_(n, NONE),
+    cols_(n),
+    diagonals_(2 * n),
+    antidiagonals_(2 * n)
+{}
+
+uint64_t dynamic_board::free_columns(const size_t r, const size_t c) const
+{
+    uint64_t mask = ~(cols_.window(c) |
+            diagonals_.window(r + c) |
+            antidiagonals_.window(c + size() - 1 - r));
+    if (size() - c < 64)
+        mask &= (uint64_t(1) << (size() - c)) - 1;
+    return mask;
+}
+
+void dynamic_board::set(const size_t r, const size_t c)
+{
+    assert(queens_[r] == NONE && free(r, c));
+    queens_[r] = c;
+    cols_.set(c);
+    diagonals_.set(r + c);
+    antidiagonals_.set(c + size() - 1 - r);
+}
+
+void dynamic_board::clear(const size_t r)
+{
+    assert(queens_[r] != NONE);
+    const size_t c = queens_[r];
+    queens_[r] = NONE;
+    cols_.reset(c);
+    diagonals_.reset(r + c);
+    antidiagonals_.reset(c + size() - 1 - r);
+}
+
+/// @param columns The column of each row's queen.
+/// @return true iff every row has a queen and no queen can take another.
+bool valid_placement(const std::vector<uint32_t>& columns)
+{
+    const size_t n = columns.size();
+    bitset cols(n);
+    bitset diagonals(2 * n);
+    bitset antidiagonals(2 * n);
+    for (size_t r = 0; r < n; ++r) {
+        const size_t c = columns[r];
+        if (c >= n)
+            return false;
+        const size_t d = r + c;
+        const size_t a = c + n - 1 - r;
+        if (cols.test(c) || diagonals.test(d) || antidiagonals.test(a))
+            return false;
+        cols.set(c);
+        diagonals.set(d);
+        antidiagonals.set(a);
+    }
+    return true;
+}
+
+bool dynamic_board::valid() const
+{
+    return valid_placement(queens_);
+}
+
+std::ostream& operator<<(std::ostream& os, const dynamic_board& b)
+{
+    for (size_t r = 0; r < b.size(); ++r) {
+        for (size_t c = 0; c < b.size(); ++c) {
+            os << b.get(r, c) << ' ';
+        }
+        os << std::endl;
+    }
+    return os;
+}
+
+namespace detail {
+
+/// Solves by backtracking over rows, most constrained row first.
+///
+/// Each row without a queen keeps a count of its free squares, its domain.
+/// Placing a queen takes at most 3 squares from each other row, so the counts
+/// are maintained in O(N) per placement. The row with the smallest domain is
+/// placed next, and a placement leaving any row without free squares is
+/// undone at once.
+///
+/// Ties between rows are broken, and each row's free columns are tried from a
+/// column, at random. The search gives up after a number of backtracks, so
+/// that an unlucky early choice is abandoned by restarting rather than
+/// searched exhaustively.
+class mrv_solver {
+public:
+    mrv_solver(size_t n, uint64_t seed) :
+        b_(n),
+        domains_(n, n),
+        open_(n),
+        empty_(0),
+        generator_(seed),
+        backtracks_(0)
+    {
+        for (size_t r = 0; r < n; ++r)
+            open_[r] = r;
+    }
+
+    /// @return true iff a solution was found within the backtrack limit.
+    bool solve(size_t limit)
+    {
+        backtracks_ = limit;
+        return solve_(0);
+    }
+
+    const dynamic_board& get() const { return b_; }
+
+private:
+    void place(size_t r, size_t c);
+    void remove(size_t r);
+    bool solve_(size_t placed);
+
+    /// Update the domains of rows without queens by delta for the squares
+    /// attacked by a queen on (r, c) which are free.
+    void update(size_t r, size_t c, int delta);
+
+    /// @return the number of free squares a queen on (r, c) would attack.
+    size_t attacks(size_t r, size_t c) const;
+
+    /// Place a queen on each column of row r in turn and solve the rest of
+    /// the board.
+    ///
+    /// @return 1 if solved, 0 if not, or -1 if out of backtracks.
+    int solve_row(size_t placed, size_t r);
+
+    /// Place a queen on (r, c) and solve the rest of the board.
+    ///
+    /// @return as for solve_row.
+    int try_place(size_t placed, size_t r, size_t c);
+
+    dynamic_board b_;
+    std::vector<uint32_t> domains_;
+    std::vector<uint32_t> open_;    /// Rows without queens, but the current.
+    size_t empty_;                  /// Rows without queens or free squares.
+    std::mt19937_64 generator_;
+    size_t backtracks_;             /// Remaining before giving up.
+
+    /// Rows with at most this many free columns are tried in order.
+    constexpr static const size_t FEW = 32;
+};
+
+void mrv_solver::update(const size_t r, const size_t c, const int delta)
+{
+    const size_t n = b_.size();
+    for (const size_t r_ : open_) {
+        const size_t d = r_ > r ? r_ - r : r - r_;
+        size_t taken = b_.free(r_, c);
+        if (c + d < n)
+            taken += b_.free(r_, c + d);
+        if (c >= d)
+            taken += b_.free(r_, c - d);
+        if (delta < 0 && domains_[r_] != 0 && domains_[r_] == taken)
+            ++empty_;
+        else if (delta > 0 && domains_[r_] == 0 && taken != 0)
+            --empty_;
+        domains_[r_] += delta * static_cast<int>(taken);
+    }
+}
+
+size_t mrv_solver::attacks(const size_t r, const size_t c) const
+{
+    const size_t n = b_.size();
+    size_t taken = 0;
+    for (const size_t r_ : open_) {
+        const size_t d = r_ > r ? r_ - r : r - r_;
+        taken += b_.free(r_, c);
+        if (c + d < n)
+            taken += b_.free(r_, c + d);
+        if (c >= d)
+            taken += b_.free(r_, c - d);
+    }
+    return taken;
+}
+
+void mrv_solver::place(const size_t r, const size_t c)
+{
+    update(r, c, -1);
+    b_.set(r, c);
+}
+
+void mrv_solver::remove(const size_t r)
+{
+    const size_t c = b_.columns()[r];
+    b_.clear(r);
+    update(r, c, 1);
+}
+
+int mrv_solver::try_place(const size_t placed, const size_t r, const size_t c)
+{
+    place(r, c);
+    if (empty_ == 0 && solve_(placed + 1))
+        return 1;
+    remove(r);
+    if (backtracks_ == 0)
+        return -1;
+    --backtracks_;
+    return 0;
+}
+
+bool mrv_solver::solve_(const size_t placed)
+{
+    const size_t n = b_.size();
+    if (placed == n)
+        return true;
+
+    // Choose a row with the fewest free squares, and take it from the open
+    // rows.
+    size_t i = 0;
+    size_t ties = 1;
+    for (size_t j = 1; j < open_.size(); ++j) {
+        if (domains_[open_[j]] < domains_[open_[i]]) {
+            i = j;
+            ties = 1;
+        } else if (domains_[open_[j]] == domains_[open_[i]] &&
+                generator_() % ++ties == 0) {
+            i = j;
+        }
+    }
+    const size_t row = open_[i];
+    std::swap(open_[i], open_.back());
+    open_.pop_back();
+    const int result = solve_row(placed, row);
+    if (result <= 0) {
+        open_.push_back(row);
+        std::swap(open_[i], open_.back());
+    }
+    return result > 0;
+}
+
+int mrv_solver::solve_row(const size_t placed, const size_t row)
+{
+    const size_t n = b_.size();
+
+    // Try a row with few free columns in order of fewest squares attacked.
+    if (domains_[row] <= FEW) {
+        std::pair<size_t, size_t> candidates[FEW];   // Attacks, column.
+        size_t k = 0;
+        for (size_t c = 0; c < n; c += 64) {
+            uint64_t free = b_.free_columns(row, c);
+            for (; free; free &= free - 1) {
+                const size_t col = c + __builtin_ctzll(free);
+                candidates[k++] = {attacks(row, col), col};
+            }
+        }
+        std::sort(candidates, candidates + k);
+        for (size_t i = 0; i < k; ++i) {
+            const int result = try_place(placed, row, candidates[i].second);
+            if (result != 0)
+                return result;
+        }
+        return 0;
+    }
+
+    // Otherwise try its free columns, 64 at a time, from a random column to
+    // the end and then from the start.
+    const size_t first = generator_() % n;
+    const std::pair<size_t, size_t> ranges[] = {{first, n}, {0, first}};
+    for (const auto& range : ranges) {
+        for (size_t c = range.first; c < range.second; c += 64) {
+            uint64_t free = b_.free_columns(row, c);
+            if (range.second - c < 64)
+                free &= (uint64_t(1) << (range.second - c)) - 1;
+            for (; free; free &= free - 1) {
+                const int result =
+                    try_place(placed, row, c + __builtin_ctzll(free));
+                if (result != 0)
+                    return result;
+            }
+        }
+    }
+    return 0;
+}
+
+/// @return a solution for N queens found by the board template.
+template <size_t N>
+dynamic_board solve_board()
+{
+    dynamic_board b(N);
+    const auto columns = board<N>::solve().columns();
+    for (size_t r = 0; r < N; ++r)
+        b.set(r, columns[r]);
+    return b;
+}
+
+template <size_t... N>
+dynamic_board solve_board(const size_t n, std::index_sequence<N...>)
+{
+    using solver = dynamic_board (*)();
+    static const solver solvers[] = { solve_board<N + 1>... };
+    return solvers[n - 1]();
+}
+
+} // end namespace detail
+
+dynamic_board dynamic_board::solve(const size_t n)
+{
+    if (n == 2 || n == 3)
+        throw std::domain_error("no N queens solution for N = 2 or 3");
+
+    // Small boards are solved fastest by the template board's plain row order
+    // search over single word masks.
+    constexpr size_t SMALL = 16;
+    if (n >= 1 && n <= SMALL)
+        return detail::solve_board(n, std::make_index_sequence<SMALL>());
+
+    // Restart with a new seed and a larger backtrack limit until solved.
+    for (size_t attempt = 0;; ++attempt) {
+        detail::mrv_solver solver(n, n + attempt);
+        if (solver.solve(n << (attempt / 4)))
+            return solver.get();
+    }
+}
+
+} // end namespace nqueens
@@ -1,3 +1,4 @@
+#include <nqueens/constexpr.h>
 #include <nqueens/nqueens.h>
 
 int main(int argc, char** argv)
@@ -5,7 +6,8 @@ int main(int argc, char** argv)
     using namespace std;
     using namespace nqueens;
 
-    auto b = board<8>::solve();
+    // Solved at compile time.
+    const auto b = board<8>::from_columns(EIGHT_QUEENS);
     cout << b << endl;
     return 0;
 }
@@ -0,0 +1,189 @@
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <nqueens/dynamic-board.h>
+
+#pragma once
+
+namespace nqueens {
+
+namespace detail {
+
+/// Solves by local search over permutations, minimizing conflicts.
+///
+/// Queens are placed one per row and column, as a permutation, so only
+/// diagonal conflicts are possible. Each diagonal of either direction keeps a
+/// count of its queens, so the conflicts made or removed by moving a queen are
+/// found in constant time. A move swaps the columns of two rows, which keeps
+/// the permutation.
+class min_conflicts_solver {
+public:
+    min_conflicts_solver(size_t n, uint64_t seed) :
+        queens_(n),
+        diagonals_(2 * n, 0),
+        antidiagonals_(2 * n, 0),
+        collisions_(0),
+        generator_(seed)
+    {}
+
+    /// @param limit The number of swaps to try before giving up.
+    /// @return true iff a solution was found.
+    bool solve(size_t limit);
+
+    const std::vector<uint32_t>& get() const { return queens_; }
+
+private:
+    /// @return a random integer in [0, n).
+    size_t random(size_t n) { return generator_() % n; }
+
+    void add(size_t r);
+    void remove(size_t r);
+    bool attacked(size_t r) const;
+    void place();
+    bool try_swap(size_t i, size_t j);
+
+    std::vector<uint32_t> queens_;          /// The column of each row's queen.
+    std::vector<uint32_t> diagonals_;       /// Queens on diagonal r + c.
+    std::vector<uint32_t> antidiagonals_;   /// Queens on diagonal c + N - 1 - r.
+    size_t collisions_;                     /// Queens on occupied diagonals.
+    std::mt19937_64 generator_;
+};
+
+void min_conflicts_solver::add(const size_t r)
+{
+    const size_t n = queens_.size();
+    collisions_ += diagonals_[r + queens_[r]]++ > 0;
+    collisions_ += antidiagonals_[queens_[r] + n - 1 - r]++ > 0;
+}
+
+void min_conflicts_solver::remove(const size_t r)
+{
+    const size_t n = queens_.size();
+    collisions_ -= --diagonals_[r + queens_[r]] > 0;
+    collisions_ -= --antidiagonals_[queens_[r] + n - 1 - r] > 0;
+}
+
+/// @return true iff row r's queen shares a diagonal.
+bool min_conflicts_solver::attacked(const size_t r) const
+{
+    const size_t n = queens_.size();
+    return diagonals_[r + queens_[r]] > 1 ||
+        antidiagonals_[queens_[r] + n - 1 - r] > 1;
+}
+
+/// Place queens greedily: each row takes a random remaining column on free
+/// diagonals, if one is found in a few tries. Only the last rows, when free
+/// columns are scarce, take a remaining column regardless, so few conflicts
+/// are left to repair.
+void min_conflicts_solver::place()
+{
+    const size_t n = queens_.size();
+    for (size_t r = 0; r < n; ++r)
+        queens_[r] = r;
+
+    size_t r = 0;
+    for (size_t tries = 0; r < n && tries < 3 * n + n / 10; ++tries) {
+        // Rows [r, n) hold the remaining columns.
+        std::swap(queens_[r], queens_[r + random(n - r)]);
+        if (diagonals_[r + queens_[r]] == 0 &&
+                antidiagonals_[queens_[r] + n - 1 - r] == 0)
+            add(r++);
+    }
+    for (; r < n; ++r) {
+        std::swap(queens_[r], queens_[r + random(n - r)]);
+        add(r);
+    }
+}
+
+/// Swap the columns of rows i and j if that reduces the collisions.
+///
+/// @return true iff swapped.
+bool min_conflicts_solver::try_swap(const size_t i, const size_t j)
+{
+    const size_t before = collisions_;
+    remove(i);
+    remove(j);
+    std::swap(queens_[i], queens_[j]);
+    add(i);
+    add(j);
+    if (collisions_ < before)
+        return true;
+
+    remove(i);
+    remove(j);
+    std::swap(queens_[i], queens_[j]);
+    add(i);
+    add(j);
+    return false;
+}
+
+bool min_conflicts_solver::solve(size_t limit)
+{
+    const size_t n = queens_.size();
+    place();
+
+    // Repair the attacked rows, collected by a scan of all rows whenever
+    // those found by the last scan are no longer attacked.
+    std::vector<uint32_t> attacked_rows;
+    while (collisions_ > 0) {
+        attacked_rows.clear();
+        for (size_t r = 0; r < n; ++r)
+            if (attacked(r))
+                attacked_rows.push_back(r);
+
+        bool repaired = false;
+        while (!repaired && collisions_ > 0) {
+            repaired = true;
+            for (const auto i : attacked_rows) {
+                if (!attacked(i))
+                    continue;
+                repaired = false;
+                if (limit == 0)
+                    return false;
+                --limit;
+
+                const size_t j = random(n);
+                if (j != i)
+                    try_swap(i, j);
+            }
+        }
+    }
+    return true;
+}
+
+} // end namespace detail
+
+/// Find a solution to the N queens problem by min-conflicts local search,
+/// for N into the millions.
+///
+/// Queens are placed, one per row and column, greedily avoiding diagonal
+/// conflicts, which leaves a few conflicted queens in the last rows. Each
+/// conflicted queen's column is then swapped with a random row's if that
+/// reduces the conflicts, until there are none. The search restarts with a
+/// new seed if it stalls. Time and memory are O(N).
+///
+/// Boards of up to 32 queens have too few solutions for local search, so are
+/// solved by dynamic_board::solve instead, which is deterministic: the same
+/// solution is returned whatever the seed.
+///
+/// @param n The width and height of the board.
+/// @param seed The seed of the random choices, for n over 32, else ignored.
+/// @return the column of each row's queen.
+/// @exception std::domain_error if there's no solution, i.e. for n 2 or 3.
+std::vector<uint32_t> min_conflicts(const size_t n, const uint64_t seed = 0)
+{
+    // Small boards have too few solutions for local search to find easily.
+    if (n <= 32)
+        return dynamic_board::solve(n).columns();
+
+    for (size_t attempt = 0;; ++attempt) {
+        detail::min_conflicts_solver solver(n, seed + attempt);
+        if (solver.solve(100 * n))
+            return solver.get();
+    }
+}
+
+} // end namespace nqueens
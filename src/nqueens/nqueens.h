@@ -4,12 +4,25 @@
 #include <array>
 #include <iostream>
 
+#include <common/stats.h>
+
 #pragma once
 
 namespace nqueens {
 
 using RowType = uintmax_t;
 
+/// A placement of N queens, one per row, as the column of each row's queen.
+template <size_t N>
+using placement = std::array<uint8_t, N>;
+
+/// Counts of the work of board::solve().
+template <typename Policy = common::stats::disabled>
+struct solve_stats {
+    typename Policy::counter placements;    /// Queens placed.
+    typename Policy::counter backtracks;    /// Queens removed to try another.
+};
+
 /// N (default 8) queens placement solver board.
 ///
 /// The N queens must be placed on the board such that no queen can take
@@ -17,7 +30,10 @@ using RowType = uintmax_t;
 ///
 /// The solution is implemented using recursive backtracking to place a queen on
 /// each row by recursively trying to place a queen on the next row for each
-/// possible column of the current row.
+/// possible column of the current row. The columns and diagonals attacked by
+/// the queens placed so far are carried down the recursion as bitmasks, so the
+/// free columns of a row are found, and enumerated, with a few bitwise
+/// operations.
 ///
 /// @tparam N The width and height of the board. Defaults to 8. Must be less
 ///           than half the width in bits of the widest supported unsigned int
@@ -34,26 +50,68 @@ public:
 
     board() : rows_() { rows_.fill(0); }
 
+    /// @return a board with a queen on each row in the specified column.
+    static board from_columns(const placement<N>& columns);
+
     /// @return a board configured with a solution to the N queens problem.
     static board solve();
 
+    /// As solve(), recording statistics.
+    template <typename Policy>
+    static board solve(solve_stats<Policy>& stats);
+
+    /// @return the number of solutions to the N queens problem.
+    static uint64_t count_all();
+
+    /// Call f(b) for each solution b to the N queens problem, in the order
+    /// solve() would find them.
+    template <typename F>
+    static void for_each_solution(F f);
+
+    /// @param cols The columns attacked by queens placed on the rows above.
+    /// @param left The columns of the next row attacked along up/right
+    ///             diagonals.
+    /// @param right The columns of the next row attacked along up/left
+    ///              diagonals.
+    /// @return the number of ways to place queens on the remaining rows.
+    static uint64_t count(RowType cols, RowType left, RowType right);
+
+    /// Columns 0 to N-1 are bits 0 to N-1 of the masks above, so that the
+    /// lowest free column is the lowest set bit.
+    static constexpr RowType ALL = (RowType(1) << N) - 1;
+
     /// @return the rows representing the board.
     const std::array<RowType, N>& rows() const { return rows_; }
 
     /// @param r The square's row.
     /// @param c The square's column.
     /// @return true iff the specified square is occupied.
-    bool get(size_t r, size_t c) const { return rows_[r] & (1 << (N - c - 1)); }
+    bool get(size_t r, size_t c) const { return rows_[r] & bit(c); }
+
+    /// @pre There's exactly one queen on each row.
+    /// @return the column of each row's queen.
+    placement<N> columns() const;
+
+    /// @return true iff no queen can take another.
+    bool valid() const;
 
     /// Print the board configuration.
     template <size_t N_>
     friend std::ostream& operator<<(std::ostream&, const board<N_>&);
 
 private:
-    void clear(size_t r, size_t c) { rows_[r] &= ~(1 << (N - c - 1)); }
-    bool solve(size_t row);
-    void set(size_t r, size_t c) { rows_[r] |= (1 << (N - c - 1)); }
-    bool valid() const;
+    static RowType bit(size_t c) { return RowType(1) << (N - c - 1); }
+
+    void clear(size_t r, size_t c) { rows_[r] &= ~bit(c); }
+    template <typename F, typename Policy>
+    bool place(
+            size_t row,
+            RowType cols,
+            RowType left,
+            RowType right,
+            F& f,
+            solve_stats<Policy>& stats);
+    void set(size_t r, size_t c) { rows_[r] |= bit(c); }
 
     std::array<RowType, N> rows_;
 };
@@ -76,33 +134,119 @@ std::ostream& operator<<(std::ostream& os, const board<N>& b)
     return os;
 }
 
+/// Place queens on rows [row, N), calling f(*this) for each solution found
+/// until it returns false.
+///
+/// @param cols The columns attacked by the queens on the rows above.
+/// @param left The columns attacked on this row along up/right diagonals.
+/// @param right The columns attacked on this row along up/left diagonals.
+/// @param stats Records the queens placed and removed.
+/// @return false iff f returned false.
 template <size_t N>
-bool board<N>::solve(size_t row)
+template <typename F, typename Policy>
+bool board<N>::place(
+        size_t row,
+        RowType cols,
+        RowType left,
+        RowType right,
+        F& f,
+        solve_stats<Policy>& stats)
 {
-    for (size_t col = 0; col < N; ++col) {
+    if (row == N)
+        return f(static_cast<const board&>(*this)); // Placed queen on last row.
+
+    RowType free = ALL & ~(cols | left | right);
+    while (free) {
+        const RowType queen = free & -free;         // Lowest free column.
+        free ^= queen;
+        const size_t col = __builtin_ctzll(queen);
         set(row, col);
-        if (valid()) {              // Valid configuration.
-            if (row == N - 1) {
-                return true;        // DONE! Placed queen on last row.
-            }
-            if (solve(row + 1)) {   // Successful so far, try place on next row.
-                return true;        // DONE! Notify caller.
-            }
-        }
+        ++stats.placements;
+        if (!place(
+                    row + 1,
+                    cols | queen,
+                    (left | queen) >> 1,
+                    (right | queen) << 1,
+                    f,
+                    stats))
+            return false;
         clear(row, col);            // Backtrack by trying the next column.
+        ++stats.backtracks;
     }
-    return false;                   // Invalid configuration.
+    return true;
+}
+
+template <size_t N>
+board<N> board<N>::from_columns(const placement<N>& columns)
+{
+    board<N> b;
+    for (size_t r = 0; r < N; ++r) {
+        assert(columns[r] < N);
+        b.set(r, columns[r]);
+    }
+    return b;
+}
+
+template <size_t N>
+placement<N> board<N>::columns() const
+{
+    placement<N> columns;
+    for (size_t r = 0; r < N; ++r) {
+        assert(is_pow2(rows_[r]));
+        columns[r] = N - 1 - __builtin_ctzll(rows_[r]);
+    }
+    return columns;
 }
 
 template <size_t N>
 board<N> board<N>::solve()
+{
+    solve_stats<> stats;
+    return solve(stats);
+}
+
+template <size_t N>
+template <typename Policy>
+board<N> board<N>::solve(solve_stats<Policy>& stats)
 {
     board<N> b;
-    bool result = b.solve(0);
+    auto first = [] (const board&) { return false; };
+    bool result = !b.place(0, 0, 0, 0, first, stats);
     assert(result);
     return b;
 }
 
+template <size_t N>
+uint64_t board<N>::count(RowType cols, RowType left, RowType right)
+{
+    if (cols == ALL)
+        return 1;
+
+    uint64_t n = 0;
+    RowType free = ALL & ~(cols | left | right);
+    while (free) {
+        const RowType queen = free & -free;
+        free ^= queen;
+        n += count(cols | queen, (left | queen) >> 1, (right | queen) << 1);
+    }
+    return n;
+}
+
+template <size_t N>
+uint64_t board<N>::count_all()
+{
+    return count(0, 0, 0);
+}
+
+template <size_t N>
+template <typename F>
+void board<N>::for_each_solution(F f)
+{
+    board<N> b;
+    auto all = [&f] (const board& solution) { f(solution); return true; };
+    solve_stats<> stats;
+    b.place(0, 0, 0, 0, all, stats);
+}
 
 template <size_t N>
 bool valid_colums(const std::array<RowType, N>& rows)
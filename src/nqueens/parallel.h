@@ -0,0 +1,61 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <common/thread-pool.h>
+#include <nqueens/nqueens.h>
+
+#pragma once
+
+namespace nqueens {
+
+/// Count the solutions to the N queens problem on a thread pool.
+///
+/// The search tree is split at the given depth: each placement of queens on
+/// the first rows that no queen can take another is a prefix, and the
+/// solutions extending each prefix are counted by a separate task. There are
+/// roughly N^depth prefixes, many more than workers for depths of 2 or 3, so
+/// work stealing evens out their very different sizes.
+///
+/// @param pool The pool to count on.
+/// @param depth The number of rows placed in each prefix.
+/// @return the number of solutions.
+template <size_t N>
+uint64_t count_all_parallel(common::thread_pool& pool, size_t depth = 3)
+{
+    using mask = std::array<RowType, 3>;        // Columns, left, right.
+
+    // Enumerate the prefixes.
+    std::vector<mask> prefixes = {{0, 0, 0}};
+    for (size_t row = 0; row < depth && row < N; ++row) {
+        std::vector<mask> next;
+        for (const auto& p : prefixes) {
+            RowType free = board<N>::ALL & ~(p[0] | p[1] | p[2]);
+            while (free) {
+                const RowType queen = free & -free;
+                free ^= queen;
+                next.push_back({
+                        p[0] | queen,
+                        (p[1] | queen) >> 1,
+                        (p[2] | queen) << 1});
+            }
+        }
+        prefixes.swap(next);
+    }
+
+    std::vector<uint64_t> counts(prefixes.size());
+    for (size_t i = 0; i < prefixes.size(); ++i) {
+        pool.submit([&prefixes, &counts, i] (size_t) {
+            const auto& p = prefixes[i];
+            counts[i] = board<N>::count(p[0], p[1], p[2]);
+        });
+    }
+    pool.wait();
+
+    uint64_t n = 0;
+    for (const auto c : counts)
+        n += c;
+    return n;
+}
+
+} // end namespace nqueens
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+
+#include <nqueens/constexpr.h>
+#include <nqueens/nqueens.h>
+
+#pragma once
+
+namespace nqueens {
+
+/// A stream of all the solutions to the N queens problem, found one at a time
+/// on demand.
+///
+/// The search state is kept explicitly rather than on the call stack, as for
+/// constexpr_solve(): for each row, the masks of columns and diagonals
+/// attacked by the queens above and the free columns not yet tried. Finding
+/// the next solution resumes the search from that state, so the solutions are
+/// visited in the order of board<N>::for_each_solution without storing them or
+/// allocating.
+///
+/// The stream is also a range of its remaining solutions, e.g.
+///     for (const auto& p : solution_stream<8>()) ...
+template <size_t N>
+class solution_stream {
+public:
+    /// An input iterator over the remaining solutions.
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = placement<N>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const placement<N>*;
+        using reference = const placement<N>&;
+
+        explicit iterator(solution_stream* s = nullptr) : s_(s) {}
+
+        const placement<N>& operator*() const { return s_->get(); }
+        const placement<N>* operator->() const { return &s_->get(); }
+
+        iterator& operator++()
+        {
+            if (!s_->next())
+                s_ = nullptr;
+            return *this;
+        }
+
+        bool operator==(const iterator& o) const { return s_ == o.s_; }
+        bool operator!=(const iterator& o) const { return s_ != o.s_; }
+
+    private:
+        solution_stream* s_;                /// Null at the end.
+    };
+
+    /// Find the next solution.
+    ///
+    /// @return false iff there are no more solutions.
+    bool next()
+    {
+        if (!detail::next(s_))
+            return false;
+        std::copy(s_.columns.data, s_.columns.data + N, columns_.begin());
+        return true;
+    }
+
+    /// @pre next() returned true.
+    /// @return the current solution.
+    const placement<N>& get() const { return columns_; }
+
+    /// @return an iterator at the next solution.
+    iterator begin() { return ++iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    detail::search_state<N> s_;
+    placement<N> columns_;
+};
+
+/// Writes solutions to a stream as N bytes each, the column of each row's
+/// queen, buffering a block of solutions between writes.
+template <size_t N>
+class solution_writer {
+public:
+    explicit solution_writer(std::ostream& os) : os_(os), size_(0) {}
+    solution_writer(const solution_writer&) = delete;
+    solution_writer& operator=(const solution_writer&) = delete;
+    ~solution_writer() { flush(); }
+
+    void write(const placement<N>& p)
+    {
+        if (size_ + N > buffer_.size())
+            flush();
+        std::copy(begin(p), end(p), begin(buffer_) + size_);
+        size_ += N;
+    }
+
+    /// Write any buffered solutions to the stream.
+    void flush()
+    {
+        os_.write(reinterpret_cast<const char*>(buffer_.data()), size_);
+        size_ = 0;
+    }
+
+private:
+    std::ostream& os_;
+    std::array<uint8_t, 65536> buffer_;
+    size_t size_;
+};
+
+/// Write all the solutions to a stream, as by solution_writer.
+///
+/// @return the number of solutions.
+template <size_t N>
+uint64_t write_solutions(std::ostream& os)
+{
+    solution_writer<N> writer(os);
+    uint64_t n = 0;
+    for (const auto& p : solution_stream<N>()) {
+        writer.write(p);
+        ++n;
+    }
+    return n;
+}
+
+} // end namespace nqueens
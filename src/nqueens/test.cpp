@@ -0,0 +1,300 @@
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <nqueens/completion.h>
+#include <nqueens/constexpr.h>
+#include <nqueens/dynamic-board.h>
+#include <nqueens/min-conflicts.h>
+#include <nqueens/nqueens.h>
+#include <nqueens/parallel.h>
+#include <nqueens/stream.h>
+#include <nqueens/unique.h>
+
+using namespace std;
+using namespace nqueens;
+
+/// The number of solutions for N = 0 to 16.
+static const uint64_t COUNTS[] = {
+    1, 1, 0, 0, 2, 10, 4, 40, 92, 352, 724, 2680, 14200, 73712, 365596,
+    2279184, 14772512 };
+
+/// Check the first solution, and the count and validity of all solutions.
+template <size_t N>
+static void test_solve()
+{
+    assert(board<N>::count_all() == COUNTS[N]);
+
+    uint64_t n = 0;
+    board<N> first;
+    board<N>::for_each_solution([&] (const board<N>& b) {
+        assert(b.valid());
+        for (size_t r = 0; r < N; ++r)
+            assert(is_pow2(b.rows()[r]));
+        if (n++ == 0)
+            first = b;
+    });
+    assert(n == COUNTS[N]);
+
+    if (n > 0)
+        assert(board<N>::solve().rows() == first.rows());
+}
+
+/// Check parallel counts, for prefixes of up to and beyond N rows.
+template <size_t N>
+static void test_parallel(common::thread_pool& pool)
+{
+    for (size_t depth = 0; depth <= 4; ++depth)
+        assert(count_all_parallel<N>(pool, depth) == COUNTS[N]);
+}
+
+/// The number of unique solutions for N = 0 to 14.
+static const uint64_t UNIQUE_COUNTS[] = {
+    1, 1, 0, 0, 1, 2, 1, 6, 12, 46, 92, 341, 1787, 9233, 45752 };
+
+/// Check unique counts, and that every solution is a variant of exactly one
+/// unique solution.
+template <size_t N>
+static void test_unique()
+{
+    std::vector<placement<N>> unique;
+    const auto counts = for_each_unique_solution<N>([&] (const placement<N>& p) {
+        assert(board<N>::from_columns(p).valid());
+        unique.push_back(p);
+    });
+    assert(counts.unique == UNIQUE_COUNTS[N]);
+    assert(counts.total == COUNTS[N]);
+    assert(unique.size() == counts.unique);
+    assert(counts.rotate90 + counts.rotate180 + counts.asymmetric == counts.unique);
+    if (N > 1) {
+        assert(2 * counts.rotate90 + 4 * counts.rotate180 +
+                8 * counts.asymmetric == counts.total);
+    }
+
+    std::set<placement<N>> variants;
+    for (const auto& p : unique)
+        for (const auto& t : transforms<N>(p))
+            variants.insert(t);
+    assert(variants.size() == counts.total);
+    board<N>::for_each_solution([&] (const board<N>& b) {
+        assert(variants.count(b.columns()) == 1);
+    });
+}
+
+/// Check runtime sized boards, solved by the template board and by MRV search.
+static void test_dynamic_board()
+{
+    for (size_t n : {1, 4, 5, 8, 16, 17, 20, 31, 32, 33, 64, 65, 100, 1000}) {
+        const auto b = dynamic_board::solve(n);
+        assert(b.size() == n);
+        assert(b.valid());
+    }
+    assert((dynamic_board::solve(8).columns() == std::vector<uint32_t>{
+            0, 4, 7, 5, 2, 6, 1, 3}));
+
+    for (size_t n : {2, 3}) {
+        bool thrown = false;
+        try {
+            dynamic_board::solve(n);
+        } catch (const std::domain_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // Free columns are found across words.
+    dynamic_board b(130);
+    b.set(0, 0);
+    b.set(1, 129);
+    assert(!b.free(2, 0) && !b.free(2, 2) && !b.free(2, 128));
+    assert(!b.free(2, 129) && b.free(2, 1) && b.free(2, 127));
+    const uint64_t free = b.free_columns(2, 100);
+    assert((free >> 27 & 1) && !(free >> 28 & 1) && !(free >> 29 & 1));
+    assert(free >> 30 == 0);
+    b.clear(1);
+    assert(b.free(2, 129) && !b.valid());
+}
+
+/// Check min-conflicts solutions, including for many seeds on small boards.
+static void test_min_conflicts()
+{
+    for (size_t n : {1, 4, 8, 32, 33, 34, 50, 1000, 100000})
+        assert(valid_placement(min_conflicts(n)));
+    for (uint64_t seed = 0; seed < 100; ++seed)
+        assert(valid_placement(min_conflicts(40, seed)));
+
+    assert(!valid_placement({0, 1}));
+    assert(!valid_placement({0, 0, 0}));
+    assert(!valid_placement({1, 3, 0, 4}));
+    assert(valid_placement({1, 3, 0, 2}));
+}
+
+/// Check the stream yields the solutions in order, and resumes after each.
+template <size_t N>
+static void test_stream()
+{
+    std::vector<placement<N>> expected;
+    board<N>::for_each_solution([&] (const board<N>& b) {
+        expected.push_back(b.columns());
+    });
+
+    solution_stream<N> s;
+    size_t n = 0;
+    while (n < expected.size() / 2 && s.next())
+        assert(s.get() == expected[n++]);
+    for (const auto& p : s)
+        assert(p == expected[n++]);
+    assert(n == expected.size());
+    assert(!s.next());
+
+    std::ostringstream os;
+    assert(write_solutions<N>(os) == expected.size());
+    const std::string bytes = os.str();
+    assert(bytes.size() == N * expected.size());
+    for (size_t k = 0; k < expected.size(); ++k)
+        for (size_t r = 0; r < N; ++r)
+            assert(static_cast<uint8_t>(bytes[k * N + r]) == expected[k][r]);
+}
+
+/// Check completions of random partial placements against all solutions.
+template <size_t N>
+static void test_completion(const size_t fixed)
+{
+    std::vector<placement<N>> solutions;
+    board<N>::for_each_solution([&] (const board<N>& b) {
+        solutions.push_back(b.columns());
+    });
+
+    std::mt19937_64 generator(N);
+    for (size_t k = 0; k < 200; ++k) {
+        placement<N> p;
+        p.fill(NO_QUEEN);
+        for (size_t i = 0; i < fixed; ++i)
+            p[generator() % N] = generator() % N;
+
+        auto extends = [&] (const placement<N>& s) {
+            for (size_t r = 0; r < N; ++r)
+                if (p[r] != NO_QUEEN && p[r] != s[r])
+                    return false;
+            return true;
+        };
+        bool expected = false;
+        for (const auto& s : solutions)
+            expected = expected || extends(s);
+
+        auto q = p;
+        assert(complete<N>(q) == expected);
+        if (expected) {
+            assert(extends(q));
+            assert(board<N>::from_columns(q).valid());
+        } else {
+            assert(q == p);
+        }
+    }
+}
+
+/// Check compile time solutions and counts against the runtime search.
+static void test_constexpr()
+{
+    static_assert(SOLUTION_COUNTS[0] == 1, "");
+    static_assert(SOLUTION_COUNTS[3] == 2, "");
+    static_assert(SOLUTION_COUNTS[7] == 92, "");
+    static_assert(EIGHT_QUEENS[0] == 0 && EIGHT_QUEENS[7] == 3, "");
+    for (size_t n = 0; n < SOLUTION_COUNTS.size(); ++n)
+        assert(SOLUTION_COUNTS[n] == COUNTS[n + 1]);
+    assert(EIGHT_QUEENS == board<8>::solve().columns());
+
+    // The same search at runtime.
+    assert(constexpr_solve<20>() == board<20>::solve().columns());
+    assert(constexpr_count<12>() == COUNTS[12]);
+}
+
+/// Check solve() records every queen placed and removed.
+template <size_t N>
+static void test_stats()
+{
+    solve_stats<common::stats::enabled> stats;
+    assert(board<N>::solve(stats).rows() == board<N>::solve().rows());
+    assert(stats.placements.value() - stats.backtracks.value() == N);
+
+    solve_stats<> disabled;
+    assert(board<N>::solve(disabled).rows() == board<N>::solve().rows());
+    assert(disabled.placements.value() == 0);
+}
+
+int main(int argc, char** argv)
+{
+    test_solve<1>();
+    test_solve<2>();
+    test_solve<3>();
+    test_solve<4>();
+    test_solve<5>();
+    test_solve<6>();
+    test_solve<7>();
+    test_solve<8>();
+    test_solve<9>();
+    test_solve<10>();
+    test_solve<11>();
+    test_solve<12>();
+
+    assert(board<14>::count_all() == COUNTS[14]);
+
+    common::thread_pool pool(3);
+    test_parallel<1>(pool);
+    test_parallel<3>(pool);
+    test_parallel<4>(pool);
+    test_parallel<8>(pool);
+    test_parallel<13>(pool);
+
+    test_unique<1>();
+    test_unique<2>();
+    test_unique<3>();
+    test_unique<4>();
+    test_unique<5>();
+    test_unique<6>();
+    test_unique<7>();
+    test_unique<8>();
+    test_unique<9>();
+    test_unique<10>();
+    assert(count_unique<13>().unique == UNIQUE_COUNTS[13]);
+    assert(count_unique<13>().total == COUNTS[13]);
+
+    test_stream<1>();
+    test_stream<3>();
+    test_stream<6>();
+    test_stream<8>();
+    test_stream<11>();
+
+    test_completion<1>(1);
+    test_completion<4>(1);
+    test_completion<8>(2);
+    test_completion<8>(3);
+    test_completion<10>(4);
+    test_completion<12>(6);
+
+    test_constexpr();
+
+    test_stats<1>();
+    test_stats<8>();
+    test_stats<20>();
+
+    // Placing 0, 2 and 3, 1 on the first rows of 4 fails, then 1, 3, 0, 2.
+    solve_stats<common::stats::enabled> stats;
+    board<4>::solve(stats);
+    assert(stats.placements.value() == 8 && stats.backtracks.value() == 4);
+
+    test_dynamic_board();
+    test_min_conflicts();
+
+    // The first 8 queens solution, as found by validating each placement.
+    const auto b = board<8>::solve();
+    const RowType expected[] = {
+        0x80, 0x08, 0x01, 0x04, 0x20, 0x02, 0x40, 0x10 };
+    for (size_t r = 0; r < 8; ++r)
+        assert(b.rows()[r] == expected[r]);
+    cout << b << endl;
+    return 0;
+}
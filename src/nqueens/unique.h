@@ -0,0 +1,134 @@
+#include <array>
+#include <cstdint>
+
+#include <nqueens/nqueens.h>
+
+#pragma once
+
+namespace nqueens {
+
+/// Counts of the solutions to the N queens problem.
+struct symmetry_counts {
+    uint64_t unique = 0;        /// Solutions up to rotation and reflection.
+    uint64_t total = 0;         /// All solutions.
+
+    // Unique solutions by symmetry group. A solution is never its own
+    // reflection, for N > 1, so its only symmetries are rotations.
+    uint64_t rotate90 = 0;      /// Unchanged by a quarter turn: 2 variants.
+    uint64_t rotate180 = 0;     /// Unchanged by only a half turn: 4 variants.
+    uint64_t asymmetric = 0;    /// 8 variants.
+};
+
+/// @return the 8 rotations and reflections of a placement, the identity first.
+template <size_t N>
+std::array<placement<N>, 8> transforms(const placement<N>& p)
+{
+    std::array<placement<N>, 8> t;
+    for (size_t r = 0; r < N; ++r) {
+        const uint8_t c = p[r];
+        const uint8_t r_ = N - 1 - r;
+        const uint8_t c_ = N - 1 - c;
+        t[0][r] = c;            // Identity.
+        t[1][c] = r_;           // Quarter turn clockwise.
+        t[2][r_] = c_;          // Half turn.
+        t[3][c_] = r;           // Quarter turn anticlockwise.
+        t[4][r] = c_;           // Reflect left to right.
+        t[5][c] = r;            // Reflect on the leading diagonal.
+        t[6][r_] = c;           // Reflect top to bottom.
+        t[7][c_] = r_;          // Reflect on the other diagonal.
+    }
+    return t;
+}
+
+namespace detail {
+
+/// Place queens on rows [row, N), calling f(p) for each solution p.
+template <size_t N, typename F>
+void place(
+        placement<N>& p,
+        size_t row,
+        RowType cols,
+        RowType left,
+        RowType right,
+        F& f)
+{
+    if (row == N) {
+        f(static_cast<const placement<N>&>(p));
+        return;
+    }
+
+    RowType free = board<N>::ALL & ~(cols | left | right);
+    while (free) {
+        const RowType queen = free & -free;
+        free ^= queen;
+        p[row] = __builtin_ctzll(queen);
+        place<N>(
+                p,
+                row + 1,
+                cols | queen,
+                (left | queen) >> 1,
+                (right | queen) << 1,
+                f);
+    }
+}
+
+} // end namespace detail
+
+/// Call f(p) for each unique solution p to the N queens problem, i.e. one
+/// solution of each set related by rotation and reflection, and count them.
+///
+/// Reflecting a solution left to right moves the first row's queen from column
+/// c to N-1-c, so only solutions with the first queen in the left half, or the
+/// middle column for odd N, are searched: half the search tree. Each solution
+/// is compared with its 7 other rotations and reflections and is unique iff it
+/// is the least of them in row order, which always has the first queen in the
+/// searched columns. Its symmetry group follows from which transforms leave it
+/// unchanged.
+///
+/// @return the solution counts.
+template <size_t N, typename F>
+symmetry_counts for_each_unique_solution(F f)
+{
+    symmetry_counts counts;
+    uint64_t searched = 0;
+    auto classify = [&] (const placement<N>& p) {
+        ++searched;
+        const auto t = transforms<N>(p);
+        for (size_t i = 1; i < 8; ++i)
+            if (t[i] < p)
+                return;
+
+        ++counts.unique;
+        if (t[1] == p)
+            ++counts.rotate90;
+        else if (t[2] == p)
+            ++counts.rotate180;
+        else
+            ++counts.asymmetric;
+        f(p);
+    };
+
+    placement<N> p;
+    for (size_t c = 0; c < (N + 1) / 2; ++c) {
+        const RowType queen = RowType(1) << c;
+        p[0] = c;
+        detail::place<N>(p, 1, queen, queen >> 1, queen << 1, classify);
+
+        // Count each left half solution's reflection.
+        if (c < N / 2)
+            counts.total += 2 * searched;
+        else
+            counts.total += searched;
+        searched = 0;
+    }
+    return counts;
+}
+
+/// @return the counts of unique and all solutions to the N queens problem.
+template <size_t N>
+symmetry_counts count_unique()
+{
+    return for_each_unique_solution<N>([] (const placement<N>&) {});
+}
+
+} // end namespace nqueens
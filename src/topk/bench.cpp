@@ -0,0 +1,49 @@
+// vim: set ts=4 sw=4 tw=80 expandtab
+// Copyright 2015 Migrant Coder
+
+/// Benchmark the top K solutions.
+
+#include <memory>
+#include <random>
+#include <string>
+
+#include <common/bench.h>
+#include <topk/topk.h>
+
+using namespace std;
+using namespace topk;
+using common::bench::harness;
+using common::bench::keep;
+
+/// \return \c n elements with random ratings.
+static unique_ptr<element[]> generate(const size_t n)
+{
+    mt19937_64 generator(n);
+    auto es = make_unique<element[]>(n);
+    for (size_t i = 0; i < n; ++i)
+        es[i] = element(i, generator() % (MAX_RATING + 1));
+    return es;
+}
+
+int main(int argc, char** argv)
+{
+    harness h(argc, argv);
+    for (size_t n : {10000, 100000, 1000000}) {
+        const auto es = generate(n);
+        for (size_t k : {10, 1000}) {
+            const string size = to_string(n) + "/" + to_string(k);
+            h.run("topk_by_pq/" + size, n, [&] () {
+                keep(topk_by_pq(es.get(), n, k));
+            });
+            h.run("topk_by_pq_stats/" + size, n, [&] () {
+                topk_stats<common::stats::enabled> stats;
+                keep(topk_by_pq(es.get(), n, k, stats));
+                keep(stats.heap.comparisons.value());
+            });
+            h.run("topk_by_sort/" + size, n, [&] () {
+                keep(topk_by_sort(es.get(), n, k));
+            });
+        }
+    }
+    return h.finish();
+}
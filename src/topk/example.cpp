@@ -4,6 +4,7 @@
 #include <topk/topk.h>
 
 #include <cstdio>
+#include <cstring>
 
 using namespace std;
 using namespace topk;
@@ -60,7 +61,7 @@ int main(const int argc, const char** const argv)
 
     const size_t N = static_cast<size_t>(n);
     const size_t K = static_cast<size_t>(k);
-    topk_t* S = naive ? topk_by_sort : topk_by_pq;
+    topk_t* S = naive ? topk_by_sort : static_cast<topk_t*>(topk_by_pq);
 
     run_example(N, K, S);
 
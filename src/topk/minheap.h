@@ -6,18 +6,29 @@
 
 #include <queue>
 
+#include <common/stats.h>
+
 namespace topk {
 
+/// Counts of the work of a \c minheap.
+template <typename Policy = common::stats::disabled>
+struct heap_stats {
+    typename Policy::counter comparisons;       /// Element comparisons.
+    typename Policy::counter sifts;             /// Elements moved a level up or down.
+};
+
 /// A minimum binary heap backed by a \c std::deque.
-template <typename T>
+///
+/// \tparam Stats The \c heap_stats of its operations since construction.
+template <typename T, typename Stats = heap_stats<>>
 class minheap {
 public:
     minheap() = default;
     ~minheap() = default;
     minheap(const minheap&) = default;
-    minheap(minheap&& o) : _heap(std::move(o._heap)) {}
+    minheap(minheap&& o) : _heap(std::move(o._heap)), _stats(o._stats) {}
     minheap& operator=(const minheap&) = default;
-    minheap& operator=(minheap&& o) { _heap = std::move(o._heap); }
+    minheap& operator=(minheap&& o) { _heap = std::move(o._heap); _stats = o._stats; return *this; }
 
     bool empty() const { return _heap.empty(); }
     void pop();
@@ -25,6 +36,7 @@ public:
     void push(T&&);
     size_t size() const { return _heap.size(); }
     const T& top() const;
+    const Stats& stats() const { return _stats; }
 
     /// \exception \c std::logic_error if the object invariants don't hold.
     void validate_properties() const;
@@ -41,11 +53,15 @@ private:
 
     void validate_order(size_t index) const;     /// \exception \c std::logic_error if the object order property doesn't hold.
 
+    /// \return a < b, counting the comparison.
+    bool less(const T& a, const T& b) { ++_stats.comparisons; return a < b; }
+
     std::deque<T> _heap;
+    Stats _stats;
 };
 
-template <typename T>
-void minheap<T>::pop()
+template <typename T, typename Stats>
+void minheap<T, Stats>::pop()
 {
     assert(!_heap.empty());
 
@@ -61,8 +77,8 @@ void minheap<T>::pop()
     sift_first();
 }
 
-template <typename T>
-void minheap<T>::sift_first()
+template <typename T, typename Stats>
+void minheap<T, Stats>::sift_first()
 {
     assert(!_heap.empty());
 
@@ -80,46 +96,48 @@ void minheap<T>::sift_first()
         auto& leftchild = _heap[l];
         if (r >= _heap.size()) {
             // The left child is the last element in the heap.
-            if (leftchild < element) {
+            if (less(leftchild, element)) {
                 std::swap(leftchild, element);
+                ++_stats.sifts;
             }
             break;
         }
         auto& rightchild = _heap[r];
-        if (element < leftchild && element < rightchild) {
+        if (less(element, leftchild) && less(element, rightchild)) {
             // The heap invariant holds again.
             break;
         }
 
         // Sift left or right depending on child priority.
-        if (leftchild < rightchild) {
+        if (less(leftchild, rightchild)) {
             std::swap(leftchild, element);
             i = l;
         } else {
             std::swap(rightchild, element);
             i = r;
         }
+        ++_stats.sifts;
     }
 }
 
-template <typename T>
-void minheap<T>::push(const T& e)
+template <typename T, typename Stats>
+void minheap<T, Stats>::push(const T& e)
 {
     // Append to the heap and bubble up.
     _heap.push_back(e);
     bubble_last();
 }
 
-template <typename T>
-void minheap<T>::push(T&& e)
+template <typename T, typename Stats>
+void minheap<T, Stats>::push(T&& e)
 {
     // Append to the heap and bubble up.
     _heap.emplace_back(e);
     bubble_last();
 }
 
-template <typename T>
-void minheap<T>::bubble_last()
+template <typename T, typename Stats>
+void minheap<T, Stats>::bubble_last()
 {
     assert(!_heap.empty());
 
@@ -128,28 +146,29 @@ void minheap<T>::bubble_last()
         return;
     }
     size_t p = parent_index(i);
-    while (i > 0 && _heap[i] < _heap[p]) {
+    while (i > 0 && less(_heap[i], _heap[p])) {
         std::swap(_heap[i], _heap[p]);
+        ++_stats.sifts;
         i = p;
         p = parent_index(i);
     }
 }
 
 
-template <typename T>
-const T& minheap<T>::top() const
+template <typename T, typename Stats>
+const T& minheap<T, Stats>::top() const
 {
     return _heap.front();
 }
 
-template <typename T>
-void minheap<T>::validate_properties() const
+template <typename T, typename Stats>
+void minheap<T, Stats>::validate_properties() const
 {
     validate_order(0);
 }
 
-template <typename T>
-void minheap<T>::validate_order(const size_t i) const
+template <typename T, typename Stats>
+void minheap<T, Stats>::validate_order(const size_t i) const
 {
     const size_t l = left_child_index(i);
     const size_t r = right_child_index(i);
@@ -17,6 +17,7 @@
 #include <memory>
 #include <vector>
 
+#include <common/stats.h>
 #include <topk/minheap.h>
 
 namespace topk {
@@ -57,26 +58,40 @@ std::vector<element> topk(const element* const es, const size_t n, const size_t
 /// Signature for solution functions.
 typedef decltype(topk) topk_t;
 
-/// Implement \c topk using a priority queue to track top K.
+/// Counts and phase timings of \c topk_by_pq.
+template <typename Policy = common::stats::disabled>
+struct topk_stats {
+    heap_stats<Policy> heap;
+    typename Policy::timer scan;                /// Finding the top K.
+    typename Policy::timer drain;               /// Ordering them.
+};
+
+/// Implement \c topk using a priority queue to track top K, recording
+/// statistics.
 ///
 /// Runtime O(n) = n log k.
-std::vector<element> topk_by_pq(const element* const es, const size_t n, const size_t k)
+template <typename Policy>
+std::vector<element> topk_by_pq(const element* const es, const size_t n, const size_t k, topk_stats<Policy>& stats)
 {
     using namespace std;
 
     // Find the top K rated elements.
-    minheap<element> ts;
-    for (size_t i = 0; i < n; ++i) {
-        const auto& e = es[i];
-        if (ts.size() < k) {
-            ts.push(e);
-        } else if (ts.top() < e) {
-            ts.pop();
-            ts.push(e);
+    minheap<element, heap_stats<Policy>> ts;
+    {
+        const auto timing = stats.scan.time();
+        for (size_t i = 0; i < n; ++i) {
+            const auto& e = es[i];
+            if (ts.size() < k) {
+                ts.push(e);
+            } else if (ts.top() < e) {
+                ts.pop();
+                ts.push(e);
+            }
         }
     }
 
     // Return in descending order.
+    const auto timing = stats.drain.time();
     vector<element> topk;
     topk.reserve(k);
     while (!ts.empty()) {
@@ -84,9 +99,19 @@ std::vector<element> topk_by_pq(const element* const es, const size_t n, const s
         ts.pop();
     }
     reverse(begin(topk), end(topk));
+    stats.heap = ts.stats();
     return topk;
 }
 
+/// Implement \c topk using a priority queue to track top K.
+///
+/// Runtime O(n) = n log k.
+std::vector<element> topk_by_pq(const element* const es, const size_t n, const size_t k)
+{
+    topk_stats<> stats;
+    return topk_by_pq(es, n, k, stats);
+}
+
 /// Implement \c topk by sorting all N elements.
 ///
 /// Runtime O(n) = n log n.